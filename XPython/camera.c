@@ -3,9 +3,14 @@
 #include <sys/time.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <math.h>
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMCamera.h>
+#include <XPLM/XPLMProcessing.h>
 #include "utils.h"
+#include "trace.h"
+#include "camerapath.h"
 
 static intptr_t camCntr;
 static PyObject *camDict;
@@ -21,8 +26,28 @@ static int cameraControl(XPLMCameraPosition_t *outCameraPosition, int inIsLosing
     return 0;
   }
 
+  // With a position buffer, the float array maps onto XPLMCameraPosition_t: it is
+  //  filled and read back with a copy, and can't be resized while the callback has it.
+  PyObject *posBuffer = PyTuple_GetItem(callbackInfo, 4);
+  Py_buffer view = {0};
   PyObject *pos;
-  if(!inIsLosingControl){
+  if(inIsLosingControl || outCameraPosition == NULL){
+    pos = Py_None;
+    Py_INCREF(pos);
+  }else if(posBuffer != Py_None){
+    if(PyObject_GetBuffer(posBuffer, &view, PyBUF_WRITABLE) < 0){
+      PyErr_Print();
+      return 0;
+    }
+    if(view.len != sizeof(XPLMCameraPosition_t)){
+      PyBuffer_Release(&view);
+      printf("Camera position buffer must hold 7 floats.\n");
+      return 0;
+    }
+    memcpy(view.buf, outCameraPosition, sizeof(XPLMCameraPosition_t));
+    pos = posBuffer;
+    Py_INCREF(pos);
+  }else{
     pos = PyList_New(7);
     PyList_SetItem(pos, 0, PyFloat_FromDouble(outCameraPosition->x));
     PyList_SetItem(pos, 1, PyFloat_FromDouble(outCameraPosition->y));
@@ -31,22 +56,24 @@ static int cameraControl(XPLMCameraPosition_t *outCameraPosition, int inIsLosing
     PyList_SetItem(pos, 4, PyFloat_FromDouble(outCameraPosition->heading));
     PyList_SetItem(pos, 5, PyFloat_FromDouble(outCameraPosition->roll));
     PyList_SetItem(pos, 6, PyFloat_FromDouble(outCameraPosition->zoom));
-  }else{
-    pos = Py_None;
-    Py_INCREF(pos);
   }
 
   PyObject *fun = PyTuple_GetItem(callbackInfo, 2);
   PyObject *lc = PyLong_FromLong(inIsLosingControl);
   PyObject *refcon = PyTuple_GetItem(callbackInfo, 3);
+  traceBegin(traceCamera, PyTuple_GetItem(callbackInfo, 0), fun, inRefcon);
   PyObject *resObj = PyObject_CallFunctionObjArgs(fun, pos, lc, refcon, NULL);
+  traceEnd(traceCamera, inRefcon);
   Py_DECREF(lc);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
   }
 
-  if((outCameraPosition != NULL) && !inIsLosingControl){
+  if(view.buf){
+    memcpy(outCameraPosition, view.buf, sizeof(XPLMCameraPosition_t));
+    PyBuffer_Release(&view);
+  }else if((outCameraPosition != NULL) && !inIsLosingControl){
     PyObject *elem;
     if(PyList_Size(pos) != 7){
       PyErr_SetString(PyExc_RuntimeError ,"outCameraPosition must contain 7 floats.\n");
@@ -81,6 +108,9 @@ static int cameraControl(XPLMCameraPosition_t *outCameraPosition, int inIsLosing
     }
   }
   Py_DECREF(pos);
+  if(!resObj){
+    return 0;
+  }
   int res = PyLong_AsLong(resObj);
   Py_DECREF(resObj);
   return res;
@@ -90,21 +120,192 @@ static PyObject *XPLMControlCameraFun(PyObject *self, PyObject *args)
 {
   (void) self;
   int inHowLong;
+  int positionBuffer = 0;
   PyObject *pluginSelf, *controlFunc, *refcon;
-  if(!PyArg_ParseTuple(args, "iOO", &inHowLong, &controlFunc, &refcon)){
+  if(!PyArg_ParseTuple(args, "iOO|i", &inHowLong, &controlFunc, &refcon, &positionBuffer)){
     return NULL;
   }
+  PyObject *posBuffer = Py_None;
+  if(positionBuffer){
+    PyObject *arrayModule = PyImport_ImportModule("array");
+    if(!arrayModule){
+      return NULL;
+    }
+    posBuffer = PyObject_CallMethod(arrayModule, "array", "s(fffffff)", "f", 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+    Py_DECREF(arrayModule);
+    if(!posBuffer){
+      return NULL;
+    }
+  }else{
+    Py_INCREF(posBuffer);
+  }
   pluginSelf = get_pluginSelf();
   void *inRefcon = (void *)++camCntr;
   PyObject *refconObj = PyLong_FromVoidPtr(inRefcon);
-  PyObject *argsObj = Py_BuildValue("(OiOO)", pluginSelf, inHowLong, controlFunc, refcon);
+  PyObject *argsObj = Py_BuildValue("(OiOOO)", pluginSelf, inHowLong, controlFunc, refcon, posBuffer);
   PyDict_SetItem(camDict, refconObj, argsObj);
   Py_DECREF(argsObj);
+  Py_DECREF(posBuffer);
+  Py_DECREF(pluginSelf);
   XPLMControlCamera(inHowLong, cameraControl, inRefcon);
   Py_DECREF(refconObj);
   Py_RETURN_NONE;
 }
 
+/*
+ * XPLMControlCameraPath: keyframes are evaluated in C every frame, python is called
+ * only for events (path end, losing control, and optionally each keyframe passed).
+ * There's one camera, so one path: a new path replaces the current one. X-Plane calls
+ * for a replaced path (refcon of an older generation) are ignored.
+ */
+static struct {
+  cameraPath path;
+  intptr_t generation;
+  double startTime;
+  bool loop, keyframeEvents, ended;
+  bool released;                // ended, camera given back to X-Plane
+  int lastKey;
+  PyObject *pluginSelf, *callback, *refcon;
+} camPath;
+
+#define CAMERA_PATH_KEYFRAME 0
+#define CAMERA_PATH_END 1
+#define CAMERA_PATH_LOSING_CONTROL 2
+
+static void cameraPathRelease(void)
+{
+  Py_CLEAR(camPath.pluginSelf);
+  Py_CLEAR(camPath.callback);
+  Py_CLEAR(camPath.refcon);
+}
+
+static int cameraPathEvent(int event, int keyframe, int onError)
+{
+  if(camPath.callback == NULL || camPath.callback == Py_None){
+    return onError;
+  }
+  // The callback may replace the path, so hold on to what we pass it
+  PyObject *callback = camPath.callback;
+  PyObject *args[] = {PyLong_FromLong(event), PyLong_FromLong(keyframe), camPath.refcon};
+  Py_INCREF(callback);
+  Py_INCREF(args[2]);
+  int res = onError;
+  if(args[0] && args[1]){
+    void *inRefcon = (void *)camPath.generation;
+    traceBegin(traceCamera, camPath.pluginSelf, callback, inRefcon);
+    PyObject *resObj = callVector(callback, args, 3);
+    traceEnd(traceCamera, inRefcon);
+    if(resObj){
+      res = resObj == Py_None ? onError : (int)PyLong_AsLong(resObj);
+      Py_DECREF(resObj);
+    }
+  }
+  if(PyErr_Occurred()){
+    PyErr_Print();
+    res = onError;
+  }
+  Py_XDECREF(args[0]);
+  Py_XDECREF(args[1]);
+  Py_DECREF(args[2]);
+  Py_DECREF(callback);
+  return res;
+}
+
+static int cameraPathControl(XPLMCameraPosition_t *outCameraPosition, int inIsLosingControl, void *inRefcon)
+{
+  intptr_t generation = (intptr_t)inRefcon;
+  if(generation != camPath.generation || camPath.path.numKeys == 0){
+    return 0;
+  }
+  if(inIsLosingControl){
+    cameraPathEvent(CAMERA_PATH_LOSING_CONTROL, camPath.lastKey, 0);
+    return 0;
+  }
+  if(outCameraPosition == NULL || camPath.released){
+    return 0;
+  }
+
+  double elapsed = XPLMGetElapsedTime() - camPath.startTime;
+  double duration = cameraPathDuration(&camPath.path);
+  if(camPath.loop && duration > 0.0){
+    elapsed = fmod(elapsed, duration);
+  }
+  float pos[7];
+  int key = cameraPathEval(&camPath.path, camPath.path.keys[0] + elapsed, pos);
+  outCameraPosition->x = pos[0];
+  outCameraPosition->y = pos[1];
+  outCameraPosition->z = pos[2];
+  outCameraPosition->pitch = pos[3];
+  outCameraPosition->heading = pos[4];
+  outCameraPosition->roll = pos[5];
+  outCameraPosition->zoom = pos[6];
+
+  if(camPath.keyframeEvents && key != camPath.lastKey){
+    camPath.lastKey = key;
+    cameraPathEvent(CAMERA_PATH_KEYFRAME, key, 0);
+    if(generation != camPath.generation){
+      return 1;
+    }
+  }
+  camPath.lastKey = key;
+  if(!camPath.loop && !camPath.ended && elapsed >= duration){
+    // hold the last keyframe if the callback returns 1, else give the camera back
+    camPath.ended = true;
+    if(!cameraPathEvent(CAMERA_PATH_END, key, 0) && generation == camPath.generation){
+      camPath.released = true;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static PyObject *XPLMControlCameraPathFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  int inHowLong;
+  PyObject *keysObj, *callback = Py_None, *refcon = Py_None;
+  int loop = 0, keyframeEvents = 0;
+  if(!PyArg_ParseTuple(args, "iO|OOii", &inHowLong, &keysObj, &callback, &refcon, &loop, &keyframeEvents)){
+    return NULL;
+  }
+  if(callback != Py_None && !PyCallable_Check(callback)){
+    PyErr_SetString(PyExc_TypeError, "XPLMControlCameraPath callback must be callable or None");
+    return NULL;
+  }
+  Py_buffer keys;
+  Py_ssize_t cnt = getTypedBuffer(keysObj, &keys, 'd', false, "XPLMControlCameraPath keyframes");
+  if(cnt < 0){
+    return NULL;
+  }
+  if(cnt % CAMERA_PATH_COLS || cnt / CAMERA_PATH_COLS > INT_MAX){
+    PyBuffer_Release(&keys);
+    PyErr_SetString(PyExc_ValueError, "XPLMControlCameraPath keyframes must have 8 doubles per keyframe");
+    return NULL;
+  }
+  const char *err = cameraPathSet(&camPath.path, (const double *)keys.buf, (int)(cnt / CAMERA_PATH_COLS));
+  PyBuffer_Release(&keys);
+  if(err){
+    PyErr_Format(PyExc_ValueError, "XPLMControlCameraPath: %s", err);
+    return NULL;
+  }
+
+  cameraPathRelease();
+  camPath.pluginSelf = get_pluginSelf();
+  Py_INCREF(callback);
+  camPath.callback = callback;
+  Py_INCREF(refcon);
+  camPath.refcon = refcon;
+  camPath.loop = loop != 0;
+  camPath.keyframeEvents = keyframeEvents != 0;
+  camPath.ended = false;
+  camPath.released = false;
+  camPath.lastKey = -1;
+  camPath.startTime = XPLMGetElapsedTime();
+  ++camPath.generation;
+  XPLMControlCamera(inHowLong, cameraPathControl, (void *)camPath.generation);
+  Py_RETURN_NONE;
+}
+
 static PyObject *XPLMDontControlCameraFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -169,11 +370,16 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
   (void) args;
   PyDict_Clear(camDict);
   Py_DECREF(camDict);
+  // any X-Plane call for the path from now on is ignored
+  ++camPath.generation;
+  cameraPathRelease();
+  cameraPathFree(&camPath.path);
   Py_RETURN_NONE;
 }
 
 static PyMethodDef XPLMCameraMethods[] = {
   {"XPLMControlCamera", XPLMControlCameraFun, METH_VARARGS, ""},
+  {"XPLMControlCameraPath", XPLMControlCameraPathFun, METH_VARARGS, "Control camera along spline through keyframes."},
   {"XPLMDontControlCamera", XPLMDontControlCameraFun, METH_VARARGS, ""},
   {"XPLMIsCameraBeingControlled", XPLMIsCameraBeingControlledFun, METH_VARARGS, ""},
   {"XPLMReadCameraPosition", XPLMReadCameraPositionFun, METH_VARARGS, ""},
@@ -203,6 +409,9 @@ PyInit_XPLMCamera(void)
   if(mod){
     PyModule_AddIntConstant(mod, "xplm_ControlCameraUntilViewChanges", xplm_ControlCameraUntilViewChanges);
     PyModule_AddIntConstant(mod, "xplm_ControlCameraForever", xplm_ControlCameraForever);
+    PyModule_AddIntConstant(mod, "xplm_CameraPathKeyframe", CAMERA_PATH_KEYFRAME);
+    PyModule_AddIntConstant(mod, "xplm_CameraPathEnd", CAMERA_PATH_END);
+    PyModule_AddIntConstant(mod, "xplm_CameraPathLosingControl", CAMERA_PATH_LOSING_CONTROL);
   }
 
   return mod;
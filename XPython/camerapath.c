@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include "camerapath.h"
+
+/*
+ * Camera path interpolation.
+ *
+ * Each segment between keyframes is a cubic Hermite curve, with the tangent at a
+ * keyframe taken from its neighbours (Catmull-Rom, scaled for uneven keyframe
+ * times), so the camera passes through every keyframe without a jump in speed.
+ * Angles are unwrapped when keyframes are set (heading 350 then 10 turns 20 degrees,
+ * not 340 back), so interpolated angles may be outside 0..360.
+ */
+
+#define COL_TIME 0
+#define COL_PITCH 4
+#define COL_ROLL 6
+
+const char *cameraPathSet(cameraPath *path, const double *rows, int numKeys)
+{
+  if(numKeys < 1){
+    return "a camera path needs at least one keyframe";
+  }
+  for(int i = 1; i < numKeys; ++i){
+    if(!(rows[i * CAMERA_PATH_COLS + COL_TIME] > rows[(i - 1) * CAMERA_PATH_COLS + COL_TIME])){
+      return "camera path keyframe times must increase";
+    }
+  }
+  if(numKeys > path->maxKeys){
+    double *keys = (double *)realloc(path->keys, (size_t)numKeys * CAMERA_PATH_COLS * sizeof(double));
+    if(!keys){
+      return "can't allocate camera path";
+    }
+    path->keys = keys;
+    path->maxKeys = numKeys;
+  }
+  memcpy(path->keys, rows, (size_t)numKeys * CAMERA_PATH_COLS * sizeof(double));
+  path->numKeys = numKeys;
+
+  for(int i = 1; i < numKeys; ++i){
+    double *prev = &path->keys[(i - 1) * CAMERA_PATH_COLS];
+    double *key = &path->keys[i * CAMERA_PATH_COLS];
+    for(int col = COL_PITCH; col <= COL_ROLL; ++col){
+      double delta = key[col] - prev[col];
+      key[col] -= 360.0 * floor((delta + 180.0) / 360.0);
+    }
+  }
+  return NULL;
+}
+
+double cameraPathDuration(const cameraPath *path)
+{
+  if(path->numKeys < 1){
+    return 0.0;
+  }
+  return path->keys[(path->numKeys - 1) * CAMERA_PATH_COLS + COL_TIME] - path->keys[COL_TIME];
+}
+
+// Tangent (per second) at keyframe i, for column col
+static double cameraPathTangent(const cameraPath *path, int i, int col)
+{
+  int before = i > 0 ? i - 1 : i;
+  int after = i < path->numKeys - 1 ? i + 1 : i;
+  const double *a = &path->keys[before * CAMERA_PATH_COLS];
+  const double *b = &path->keys[after * CAMERA_PATH_COLS];
+  return (b[col] - a[col]) / (b[COL_TIME] - a[COL_TIME]);
+}
+
+int cameraPathEval(const cameraPath *path, double t, float pos[7])
+{
+  const double *keys = path->keys;
+  int last = path->numKeys - 1;
+  if(last <= 0 || t <= keys[COL_TIME]){
+    for(int col = 1; col < CAMERA_PATH_COLS; ++col){
+      pos[col - 1] = (float)keys[col];
+    }
+    return 0;
+  }
+  if(t >= keys[last * CAMERA_PATH_COLS + COL_TIME]){
+    for(int col = 1; col < CAMERA_PATH_COLS; ++col){
+      pos[col - 1] = (float)keys[last * CAMERA_PATH_COLS + col];
+    }
+    return last;
+  }
+
+  // binary search for the segment [i, i + 1] containing t
+  int lo = 0, hi = last;
+  while(hi - lo > 1){
+    int mid = (lo + hi) / 2;
+    if(keys[mid * CAMERA_PATH_COLS + COL_TIME] <= t){
+      lo = mid;
+    }else{
+      hi = mid;
+    }
+  }
+  const double *k0 = &keys[lo * CAMERA_PATH_COLS];
+  const double *k1 = &keys[hi * CAMERA_PATH_COLS];
+  double h = k1[COL_TIME] - k0[COL_TIME];
+  double s = (t - k0[COL_TIME]) / h;
+  double s2 = s * s, s3 = s2 * s;
+  double h00 = 2 * s3 - 3 * s2 + 1;
+  double h10 = s3 - 2 * s2 + s;
+  double h01 = -2 * s3 + 3 * s2;
+  double h11 = s3 - s2;
+  for(int col = 1; col < CAMERA_PATH_COLS; ++col){
+    pos[col - 1] = (float)(h00 * k0[col] + h10 * h * cameraPathTangent(path, lo, col)
+                           + h01 * k1[col] + h11 * h * cameraPathTangent(path, hi, col));
+  }
+  return lo;
+}
+
+void cameraPathFree(cameraPath *path)
+{
+  free(path->keys);
+  path->keys = NULL;
+  path->numKeys = path->maxKeys = 0;
+}
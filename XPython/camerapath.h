@@ -0,0 +1,26 @@
+#ifndef CAMERAPATH__H
+#define CAMERAPATH__H
+
+#include <stdbool.h>
+
+/* Camera path: keyframes of time and camera position, interpolated with a cubic
+   (Catmull-Rom) spline through them. */
+
+// time, x, y, z, pitch, heading, roll, zoom
+#define CAMERA_PATH_COLS 8
+
+typedef struct {
+  double *keys;             // numKeys rows of CAMERA_PATH_COLS
+  int numKeys, maxKeys;
+} cameraPath;
+
+// Copies keyframes into path. Times must increase. Returns NULL, or a message saying
+//  what's wrong with the keyframes (path unchanged).
+const char *cameraPathSet(cameraPath *path, const double *rows, int numKeys);
+double cameraPathDuration(const cameraPath *path);
+// Sets pos (x, y, z, pitch, heading, roll, zoom) at time t, clamped to the path's times.
+//  Returns the index of the last keyframe at or before t.
+int cameraPathEval(const cameraPath *path, double t, float pos[7]);
+void cameraPathFree(cameraPath *path);
+
+#endif
@@ -7,6 +7,7 @@
 #include <XPLM/XPLMDataAccess.h>
 #include <XPLM/XPLMUtilities.h>
 #include "utils.h"
+#include "trace.h"
 
 //static PyObject *rwCallbackDict;
 //static intptr_t rwCallbackCntr;
@@ -379,7 +380,9 @@ static int getDatai(void *inRefcon)
   }
   PyObject *oFun = PySequence_GetItem(pCbks, 4);
   PyObject *oArg = PySequence_GetItem(pCbks, 16);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -407,7 +410,9 @@ static void setDatai(void *inRefcon, int inValue)
   PyObject *oFun = PySequence_GetItem(pCbks, 5);
   PyObject *oArg1 = PySequence_GetItem(pCbks, 17);
   PyObject *oArg2 = PyLong_FromLong(inValue);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, oArg2, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -430,7 +435,9 @@ static float getDataf(void *inRefcon)
   }
   PyObject *oFun = PySequence_GetItem(pCbks, 6);
   PyObject *oArg1 = PySequence_GetItem(pCbks, 16);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -459,7 +466,9 @@ static void setDataf(void *inRefcon, float inValue)
   PyObject *oFun = PySequence_GetItem(pCbks, 7);
   PyObject *oArg1 = PySequence_GetItem(pCbks, 17);
   PyObject *oArg2 = PyFloat_FromDouble((double)inValue);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, oArg2, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -482,7 +491,9 @@ static double getDatad(void *inRefcon)
   }
   PyObject *oFun = PySequence_GetItem(pCbks, 8);
   PyObject *oArg = PySequence_GetItem(pCbks, 16);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -510,7 +521,9 @@ static void setDatad(void *inRefcon, double inValue)
   PyObject *oFun = PySequence_GetItem(pCbks, 9);
   PyObject *oArg1 = PySequence_GetItem(pCbks, 17);
   PyObject *oArg2 = PyFloat_FromDouble(inValue);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, oArg2, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -543,7 +556,9 @@ static int getDatavi(void *inRefcon, int *outValues, int inOffset, int inMax)
   PyObject *oArg1 = PySequence_GetItem(pCbks, 16);
   PyObject *oArg2 = PyLong_FromLong(inOffset);
   PyObject *oArg3 = PyLong_FromLong(inMax);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, outValuesObj, oArg2, oArg3, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -589,7 +604,9 @@ static void setDatavi(void *inRefcon, int *inValues, int inOffset, int inCount)
   PyObject *oArg1 = PySequence_GetItem(pCbks, 17);
   PyObject *oArg2 = PyLong_FromLong(inOffset);
   PyObject *oArg3 = PyLong_FromLong(inCount);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, inValuesObj, oArg2, oArg3, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -624,7 +641,9 @@ static int getDatavf(void *inRefcon, float *outValues, int inOffset, int inMax)
   PyObject *oArg1 = PySequence_GetItem(pCbks, 16);
   PyObject *oArg2 = PyLong_FromLong(inOffset);
   PyObject *oArg3 = PyLong_FromLong(inMax);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, outValuesObj, oArg2, oArg3, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -670,7 +689,9 @@ static void setDatavf(void *inRefcon, float *inValues, int inOffset, int inCount
   PyObject *oArg1 = PySequence_GetItem(pCbks, 17);
   PyObject *oArg2 = PyLong_FromLong(inOffset);
   PyObject *oArg3 = PyLong_FromLong(inCount);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, inValuesObj, oArg2, oArg3, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -705,7 +726,9 @@ static int getDatab(void *inRefcon, void *outValue, int inOffset, int inMax)
   PyObject *oArg1 = PySequence_GetItem(pCbks, 16);
   PyObject *oArg2 = PyLong_FromLong(inOffset);
   PyObject *oArg3 = PyLong_FromLong(inMax);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, outValuesObj, oArg2, oArg3, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -753,7 +776,9 @@ static void setDatab(void *inRefcon, void *inValue, int inOffset, int inCount)
   PyObject *oArg1 = PySequence_GetItem(pCbks, 17);
   PyObject *oArg2 = PyLong_FromLong(inOffset);
   PyObject *oArg3 = PyLong_FromLong(inCount);
+  traceBegin(traceAccessor, PyTuple_GetItem(pCbks, 0), oFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(oFun, oArg1, inValuesObj, oArg2, oArg3, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
@@ -858,7 +883,9 @@ static void dataChanged(void *inRefcon)
   }
   PyObject *callbackFun = PySequence_GetItem(sharedObj, 3);
   PyObject *arg = PySequence_GetItem(sharedObj, 4);
+  traceBegin(traceAccessor, PyTuple_GetItem(sharedObj, 0), callbackFun, inRefcon);
   PyObject *oRes = PyObject_CallFunctionObjArgs(callbackFun, arg, NULL);
+  traceEnd(traceAccessor, inRefcon);
   PyObject *err = PyErr_Occurred();
   if(err){
     PyErr_Print();
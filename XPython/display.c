@@ -5,14 +5,17 @@
 #include <stdbool.h>
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMDisplay.h>
+#include <XPLM/XPLMProcessing.h>
 #include "utils.h"
+#include "trace.h"
 #include "plugin_dl.h"
 #include "xppythontypes.h"
+#include "drawlist.h"
 
 static PyObject *drawCallbackDict, *drawCallbackIDDict;
 static intptr_t drawCallbackCntr;
 static PyObject *keySniffCallbackDict;
-static intptr_t keySniffCallbackCntr;
+static PyObject *drawListCallbackDict;
 
 //draw, key,mouse, cursor, wheel
 static PyObject *windowDict;
@@ -82,31 +85,105 @@ static PyObject *XPLMRegisterDrawCallbackFun(PyObject *self, PyObject *args)
   return PyLong_FromLong(res);
 }
 
+/* Key sniffer refcon: the (vkey, flags, mask) patterns a sniffer wants, checked in C
+   so other keystrokes are passed on without calling python. No patterns means all keys. */
+typedef struct {
+  int vkey;           // -1 matches any virtual key
+  int flags;
+  int mask;           // key matches when (inFlags & mask) == flags
+} keySnifferFilter;
+
+typedef struct {
+  int numFilters;
+  keySnifferFilter filters[];
+} keySnifferInfo;
+
+static keySnifferInfo *newKeySnifferInfo(PyObject *filtersObj)
+{
+  PyObject *seq = NULL;
+  Py_ssize_t cnt = 0;
+  if(filtersObj != Py_None){
+    seq = PySequence_Fast(filtersObj, "XPLMRegisterKeySniffer filters must be a sequence of (vkey, flags) tuples.");
+    if(!seq){
+      return NULL;
+    }
+    cnt = PySequence_Fast_GET_SIZE(seq);
+  }
+  keySnifferInfo *info = (keySnifferInfo *)malloc(sizeof(keySnifferInfo) + cnt * sizeof(keySnifferFilter));
+  if(!info){
+    Py_XDECREF(seq);
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate key sniffer.");
+    return NULL;
+  }
+  info->numFilters = (int)cnt;
+  for(Py_ssize_t i = 0; i < cnt; ++i){
+    keySnifferFilter *filter = &info->filters[i];
+    PyObject *item = PySequence_Tuple(PySequence_Fast_GET_ITEM(seq, i));
+    if(!item || !PyArg_ParseTuple(item, "ii|i", &filter->vkey, &filter->flags, &filter->mask)){
+      Py_XDECREF(item);
+      Py_DECREF(seq);
+      free(info);
+      return NULL;
+    }
+    if(PyTuple_GET_SIZE(item) == 2){
+      // by default, the given flags must be set and others don't matter
+      filter->mask = filter->flags;
+    }
+    Py_DECREF(item);
+    filter->flags &= filter->mask;
+  }
+  Py_XDECREF(seq);
+  return info;
+}
+
+static bool keySnifferWants(const keySnifferInfo *info, XPLMKeyFlags inFlags, char inVirtualKey)
+{
+  if(info->numFilters == 0){
+    return true;
+  }
+  int vkey = (unsigned char)inVirtualKey;
+  for(int i = 0; i < info->numFilters; ++i){
+    const keySnifferFilter *filter = &info->filters[i];
+    if((filter->vkey == -1 || filter->vkey == vkey) && (inFlags & filter->mask) == filter->flags){
+      return true;
+    }
+  }
+  return false;
+}
+
 static PyObject *XPLMRegisterKeySnifferFun(PyObject *self, PyObject *args)
-//PyObject *inCallback, PyObject *inBeforeWindows, PyObject *inRefcon)
+//PyObject *inCallback, PyObject *inBeforeWindows, PyObject *inRefcon, PyObject *inFilters)
 {
   (void) self;
-  PyObject *pluginSelf, *callback, *refcon;
+  PyObject *pluginSelf, *callback, *refcon, *filters = Py_None;
   int inBeforeWindows;
-  if(!PyArg_ParseTuple(args, "OiO", &callback, &inBeforeWindows, &refcon))
+  if(!PyArg_ParseTuple(args, "OiO|O", &callback, &inBeforeWindows, &refcon, &filters))
+    return NULL;
+  keySnifferInfo *info = newKeySnifferInfo(filters);
+  if(!info){
     return NULL;
+  }
   pluginSelf = get_pluginSelf();
 
-  PyObject *idx = PyLong_FromLong(++keySniffCallbackCntr);
+  PyObject *idx = PyLong_FromVoidPtr(info);
   if(!idx){
+    free(info);
     PyErr_SetString(PyExc_RuntimeError ,"Couldn't create long.\n");
     return NULL;
   }
 
   PyObject *argObj = Py_BuildValue("(OOiO)", pluginSelf, callback, inBeforeWindows, refcon);
   PyDict_SetItem(keySniffCallbackDict, idx, argObj);
-  Py_DECREF(idx);
   Py_DECREF(argObj);
-  int res = XPLMRegisterKeySniffer(XPLMKeySnifferCallback, inBeforeWindows, (void *)keySniffCallbackCntr);
+  int res = XPLMRegisterKeySniffer(XPLMKeySnifferCallback, inBeforeWindows, info);
   if(!res){
+    PyDict_DelItem(keySniffCallbackDict, idx);
+    Py_DECREF(idx);
+    free(info);
     PyErr_SetString(PyExc_RuntimeError ,"XPLMRegisterKeySnifferCallback failed.\n");
     return NULL;
   }
+  Py_DECREF(idx);
   return PyLong_FromLong(res);
 }
 
@@ -140,6 +217,169 @@ static PyObject *XPLMUnregisterDrawCallbackFun(PyObject *self, PyObject *args)
   return PyLong_FromLong(res);
 }
 
+/* Draw callbacks bound to a draw list keep their state in a C struct passed as
+   the refcon, so frames which only replay the list don't touch python at all. */
+typedef struct {
+  PyObject *pluginSelf;
+  PyObject *callback;
+  PyObject *refcon;
+  PyObject *listObj;
+  drawList *list;
+  int phase;
+  int wantsBefore;
+  float interval;
+  float lastCall;
+  int lastRes;
+  bool busy;                // in the python callback, which may unregister itself
+  bool removed;
+} drawListCallbackInfo;
+
+static void freeDrawListCallbackInfo(drawListCallbackInfo *info)
+{
+  Py_DECREF(info->pluginSelf);
+  Py_DECREF(info->callback);
+  Py_DECREF(info->refcon);
+  Py_DECREF(info->listObj);
+  free(info);
+}
+
+static int XPLMDrawListCallback(XPLMDrawingPhase inPhase, int inIsBefore, void *inRefcon)
+{
+  drawListCallbackInfo *info = (drawListCallbackInfo *)inRefcon;
+  if(info->callback != Py_None){
+    float now = XPLMGetElapsedTime();
+    if(drawListIsDirty(info->list) || (info->interval > 0.0f && now - info->lastCall >= info->interval)){
+      info->lastCall = now;
+      // cleared before the call, so the callback may mark the list dirty again
+      drawListSetDirty(info->list, false);
+      PyObject *inPhaseObj = PyLong_FromLong(inPhase);
+      PyObject *inIsBeforeObj = PyLong_FromLong(inIsBefore);
+      PyObject *callback = info->callback;
+      Py_INCREF(callback);
+      Py_INCREF(info->listObj);
+      info->busy = true;
+      traceBegin(traceDraw, info->pluginSelf, callback, inRefcon);
+      PyObject *pRes = PyObject_CallFunctionObjArgs(callback, inPhaseObj, inIsBeforeObj, info->refcon, NULL);
+      traceEnd(traceDraw, inRefcon);
+      info->busy = false;
+      Py_DECREF(callback);
+      Py_DECREF(inPhaseObj);
+      Py_DECREF(inIsBeforeObj);
+      if(!pRes){
+        printf("Draw list callback failed.\n");
+      }else if(!PyLong_Check(pRes)){
+        printf("Draw list callback returned a wrong type.\n");
+      }else{
+        info->lastRes = (int)PyLong_AsLong(pRes);
+      }
+      if(PyErr_Occurred()){
+        PyErr_Print();
+      }
+      Py_XDECREF(pRes);
+      Py_DECREF(info->listObj);
+      if(info->removed){
+        // unregistered by the callback: the list is no longer ours to draw
+        int res = info->lastRes;
+        freeDrawListCallbackInfo(info);
+        return res;
+      }
+    }
+  }
+  drawListReplay(info->list);
+  return info->lastRes;
+}
+
+static PyObject *XPLMRegisterDrawListCallbackFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *callback, *refcon, *listObj;
+  int inPhase, inWantsBefore;
+  float inInterval = 0.0f;
+  if(!PyArg_ParseTuple(args, "OiiOO|f", &callback, &inPhase, &inWantsBefore, &refcon, &listObj, &inInterval)){
+    return NULL;
+  }
+  drawList *list = drawListFromObj(listObj);
+  if(!list){
+    PyErr_SetString(PyExc_TypeError, "XPLMRegisterDrawListCallback expects a draw list created by XPLMCreateDrawList.");
+    return NULL;
+  }
+  if(callback != Py_None && !PyCallable_Check(callback)){
+    PyErr_SetString(PyExc_TypeError, "XPLMRegisterDrawListCallback expects callable or None as the callback.");
+    return NULL;
+  }
+  PyObject *refconAddr = PyLong_FromVoidPtr(refcon);
+  PyObject *key = Py_BuildValue("(OiiO)", listObj, inPhase, inWantsBefore, refconAddr);
+  Py_DECREF(refconAddr);
+  if(PyDict_Contains(drawListCallbackDict, key)){
+    Py_DECREF(key);
+    PyErr_SetString(PyExc_RuntimeError, "XPLMRegisterDrawListCallback: draw list already registered with this phase and refcon.");
+    return NULL;
+  }
+  drawListCallbackInfo *info = (drawListCallbackInfo *)malloc(sizeof(drawListCallbackInfo));
+  if(!info){
+    Py_DECREF(key);
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate draw list callback.");
+    return NULL;
+  }
+  info->pluginSelf = get_pluginSelf();
+  Py_INCREF(callback);
+  info->callback = callback;
+  Py_INCREF(refcon);
+  info->refcon = refcon;
+  Py_INCREF(listObj);
+  info->listObj = listObj;
+  info->list = list;
+  info->phase = inPhase;
+  info->wantsBefore = inWantsBefore;
+  info->interval = inInterval;
+  info->lastCall = XPLMGetElapsedTime();
+  info->lastRes = 1;
+  info->busy = false;
+  info->removed = false;
+
+  int res = XPLMRegisterDrawCallback(XPLMDrawListCallback, inPhase, inWantsBefore, info);
+  if(!res){
+    Py_DECREF(key);
+    freeDrawListCallbackInfo(info);
+    PyErr_SetString(PyExc_RuntimeError ,"XPLMRegisterDrawListCallback failed.\n");
+    return NULL;
+  }
+  PyObject *infoObj = PyLong_FromVoidPtr(info);
+  PyDict_SetItem(drawListCallbackDict, key, infoObj);
+  Py_DECREF(infoObj);
+  Py_DECREF(key);
+  return PyLong_FromLong(res);
+}
+
+static PyObject *XPLMUnregisterDrawListCallbackFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *callback, *refcon, *listObj;
+  int inPhase, inWantsBefore;
+  if(!PyArg_ParseTuple(args, "OiiOO", &callback, &inPhase, &inWantsBefore, &refcon, &listObj)){
+    return NULL;
+  }
+  PyObject *refconAddr = PyLong_FromVoidPtr(refcon);
+  PyObject *key = Py_BuildValue("(OiiO)", listObj, inPhase, inWantsBefore, refconAddr);
+  Py_DECREF(refconAddr);
+  PyObject *infoObj = PyDict_GetItem(drawListCallbackDict, key);
+  if(infoObj == NULL){
+    Py_DECREF(key);
+    PyErr_SetString(PyExc_RuntimeError ,"XPLMUnregisterDrawListCallback failed to find the callback.\n");
+    return NULL;
+  }
+  drawListCallbackInfo *info = (drawListCallbackInfo *)PyLong_AsVoidPtr(infoObj);
+  int res = XPLMUnregisterDrawCallback(XPLMDrawListCallback, inPhase, inWantsBefore, info);
+  PyDict_DelItem(drawListCallbackDict, key);
+  Py_DECREF(key);
+  if(info->busy){
+    info->removed = true;
+  }else{
+    freeDrawListCallbackInfo(info);
+  }
+  return PyLong_FromLong(res);
+}
+
 static PyObject *XPLMUnregisterKeySnifferFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -162,9 +402,11 @@ static PyObject *XPLMUnregisterKeySnifferFun(PyObject *self, PyObject *args)
   Py_DECREF(argObj);
   Py_DECREF(pluginSelf);
   if(toDelete){
+    keySnifferInfo *info = (keySnifferInfo *)PyLong_AsVoidPtr(toDelete);
     res = XPLMUnregisterKeySniffer(XPLMKeySnifferCallback, 
-                                   inBeforeWindows, PyLong_AsVoidPtr(toDelete));
+                                   inBeforeWindows, info);
     PyDict_DelItem(keySniffCallbackDict, toDelete);
+    free(info);
   }
 
   PyObject *err = PyErr_Occurred();
@@ -176,21 +418,106 @@ static PyObject *XPLMUnregisterKeySnifferFun(PyObject *self, PyObject *args)
 }
 
 
+/* Window callbacks keep their state in a C struct passed as the window refcon:
+   callables are resolved once, and the window capsule is cached, so events don't
+   need dictionary lookups. */
+typedef struct {
+  long value;
+  PyObject *obj;
+} longCache;
+
+typedef struct {
+  XPLMWindowID window;
+  PyObject *pID;
+  PyObject *drawWindow;
+  PyObject *handleMouseClick;
+  PyObject *handleKey;
+  PyObject *handleCursor;
+  PyObject *handleMouseWheel;
+  PyObject *handleRightClick;
+  PyObject *refcon;
+  longCache x, y;
+} windowCallbackInfo;
+
+static PyObject *cachedLong(longCache *cache, long value)
+{
+  // mouse coordinates often repeat between events, reuse the int object (borrowed reference)
+  if(cache->obj == NULL || cache->value != value){
+    Py_XDECREF(cache->obj);
+    cache->obj = PyLong_FromLong(value);
+    cache->value = value;
+  }
+  return cache->obj;
+}
+
+static void freeWindowCallbackInfo(windowCallbackInfo *info)
+{
+  Py_XDECREF(info->pID);
+  Py_DECREF(info->drawWindow);
+  Py_DECREF(info->handleMouseClick);
+  Py_DECREF(info->handleKey);
+  Py_DECREF(info->handleCursor);
+  Py_DECREF(info->handleMouseWheel);
+  Py_DECREF(info->handleRightClick);
+  Py_DECREF(info->refcon);
+  Py_XDECREF(info->x.obj);
+  Py_XDECREF(info->y.obj);
+  free(info);
+}
+
+static PyObject *windowCall(windowCallbackInfo *info, PyObject *callback, PyObject **args, size_t nargs)
+{
+  // The callback may destroy the window (and info), so hold on to the arguments
+  XPLMWindowID window = info->window;
+  size_t i;
+  for(i = 0; i < nargs; ++i){
+    if(args[i] == NULL){
+      PyErr_Print();
+      return NULL;
+    }
+  }
+  for(i = 0; i < nargs; ++i){
+    Py_INCREF(args[i]);
+  }
+  Py_INCREF(callback);
+  traceBegin(traceWindow, NULL, callback, window);
+  PyObject *res = callVector(callback, args, nargs);
+  traceEnd(traceWindow, window);
+  Py_DECREF(callback);
+  for(i = 0; i < nargs; ++i){
+    Py_DECREF(args[i]);
+  }
+  if(PyErr_Occurred()){
+    PyErr_Print();
+  }
+  return res;
+}
+
+static int windowCallInt(windowCallbackInfo *info, PyObject *callback, PyObject **args, size_t nargs, int onError)
+{
+  PyObject *pRes = windowCall(info, callback, args, nargs);
+  if(!pRes){
+    return onError;
+  }
+  int res = (int)PyLong_AsLong(pRes);
+  Py_DECREF(pRes);
+  if(PyErr_Occurred()){
+    PyErr_Print();
+    return onError;
+  }
+  return res;
+}
+
 static void drawWindow(XPLMWindowID  inWindowID,
                 void         *inRefcon)
 {
-  PyObject *pID = getPtrRef(inWindowID, windowIDCapsules, windowIDRef);
-  PyObject *pCbks = PyDict_GetItem(windowDict, pID);
-  if(pCbks == NULL){
+  windowCallbackInfo *info = (windowCallbackInfo *)inRefcon;
+  if(info == NULL){
     printf("Unknown window passed to drawWindow (%p).\n", inWindowID);
     return;
   }
-  PyObject *oRes = PyObject_CallFunctionObjArgs(PyTuple_GetItem(pCbks, 0), pID, inRefcon, NULL);
-  if(PyErr_Occurred()) {
-    PyErr_Print();
-  }
-  Py_XDECREF(oRes);
-  Py_DECREF(pID);
+  PyObject *args[] = {info->pID, info->refcon};
+  Py_XDECREF(windowCall(info, info->drawWindow, args, 2));
 }
 
 static void handleKey(XPLMWindowID  inWindowID,
@@ -200,11 +527,9 @@ static void handleKey(XPLMWindowID  inWindowID,
                void         *inRefcon,
                int           losingFocus)
 {
-  (void) inRefcon;
-  PyObject *pID = getPtrRef(inWindowID, windowIDCapsules, windowIDRef);
   char msg[2024];
-  PyObject *pCbks = PyDict_GetItem(windowDict, pID);
-  if(pCbks == NULL){
+  windowCallbackInfo *info = (windowCallbackInfo *)inRefcon;
+  if(info == NULL || inWindowID == NULL){
     if (inWindowID == NULL && losingFocus) {
       /* This occurs only when I have a window with keyboard focus and then
          I destroy the window (or otherwise lose focus.)
@@ -220,22 +545,14 @@ static void handleKey(XPLMWindowID  inWindowID,
     XPLMDebugString(msg);
     return;
   }
-  PyObject *arg1 = PyLong_FromLong(inKey);
-  PyObject *arg2 = PyLong_FromLong(inFlags);
-  PyObject *arg3 = PyLong_FromLong((unsigned int)inVirtualKey);
-  PyObject *arg4 = PyLong_FromLong(losingFocus);
-  // printf("Calling handleKey callback. inWindowID = %p, pPID = %s, losingFocus = %d\n", inWindowID, objToStr(pID), losingFocus);
-  PyObject *oRes = PyObject_CallFunctionObjArgs(PyTuple_GetItem(pCbks, 2), pID, arg1, arg2, arg3, inRefcon, arg4, NULL);
-  Py_XDECREF(arg1);
-  Py_XDECREF(arg2);
-  Py_XDECREF(arg3);
-  Py_XDECREF(arg4);
-  Py_XDECREF(oRes);
-  PyObject *err = PyErr_Occurred();
-  if(err){
-    PyErr_Print();
-  }
-  Py_DECREF(pID);
+  // key, flags and virtual key are small ints, which python caches
+  PyObject *args[] = {info->pID, PyLong_FromLong(inKey), PyLong_FromLong(inFlags),
+                      PyLong_FromLong((unsigned int)inVirtualKey), info->refcon, PyLong_FromLong(losingFocus)};
+  Py_XDECREF(windowCall(info, info->handleKey, args, 6));
+  Py_XDECREF(args[1]);
+  Py_XDECREF(args[2]);
+  Py_XDECREF(args[3]);
+  Py_XDECREF(args[5]);
 }
 
 static int handleMouseClick(XPLMWindowID     inWindowID,
@@ -244,28 +561,14 @@ static int handleMouseClick(XPLMWindowID     inWindowID,
                      XPLMMouseStatus  inMouse,
                      void            *inRefcon)
 {
-  (void) inRefcon;
-  PyObject *pID = getPtrRef(inWindowID, windowIDCapsules, windowIDRef);
-  PyObject *pCbks = PyDict_GetItem(windowDict, pID);
-  if(pCbks == NULL){
+  windowCallbackInfo *info = (windowCallbackInfo *)inRefcon;
+  if(info == NULL){
     printf("Unknown window passed to handleMouseClick (%p).\n", inWindowID);
     return 1;
   }
-  PyObject *arg1 = PyLong_FromLong(x);
-  PyObject *arg2 = PyLong_FromLong(y);
-  PyObject *arg3 = PyLong_FromLong(inMouse);
-  PyObject *pRes = PyObject_CallFunctionObjArgs(PyTuple_GetItem(pCbks, 1), pID, arg1, arg2, arg3, inRefcon, NULL);
-  PyObject *err = PyErr_Occurred();
-  Py_DECREF(arg1);
-  Py_DECREF(arg2);
-  Py_DECREF(arg3);
-  Py_DECREF(pID);
-  if(err){
-    PyErr_Print();
-    return 1;
-  }
-  int res = (int)PyLong_AsLong(pRes);
-  Py_DECREF(pRes);
+  PyObject *args[] = {info->pID, cachedLong(&info->x, x), cachedLong(&info->y, y), PyLong_FromLong(inMouse), info->refcon};
+  int res = windowCallInt(info, info->handleMouseClick, args, 5, 1);
+  Py_XDECREF(args[3]);
   return res;
 }
 
@@ -275,28 +578,14 @@ static int handleRightClick(XPLMWindowID     inWindowID,
                      XPLMMouseStatus  inMouse,
                      void            *inRefcon)
 {
-  (void) inRefcon;
-  PyObject *pID = getPtrRef(inWindowID, windowIDCapsules, windowIDRef);
-  PyObject *pCbks = PyDict_GetItem(windowDict, pID);
-  if(pCbks == NULL){
+  windowCallbackInfo *info = (windowCallbackInfo *)inRefcon;
+  if(info == NULL){
     printf("Unknown window passed to handleMouseClick (%p).\n", inWindowID);
     return 1;
   }
-  PyObject *arg1 = PyLong_FromLong(x);
-  PyObject *arg2 = PyLong_FromLong(y);
-  PyObject *arg3 = PyLong_FromLong(inMouse);
-  PyObject *pRes = PyObject_CallFunctionObjArgs(PyTuple_GetItem(pCbks, 5), pID, arg1, arg2, arg3, inRefcon, NULL);
-  Py_DECREF(arg1);
-  Py_DECREF(arg2);
-  Py_DECREF(arg3);
-  Py_DECREF(pID);
-  PyObject *err = PyErr_Occurred();
-  if(err){
-    PyErr_Print();
-    return 1;
-  }
-  int res = (int)PyLong_AsLong(pRes);
-  Py_DECREF(pRes);
+  PyObject *args[] = {info->pID, cachedLong(&info->x, x), cachedLong(&info->y, y), PyLong_FromLong(inMouse), info->refcon};
+  int res = windowCallInt(info, info->handleRightClick, args, 5, 1);
+  Py_XDECREF(args[3]);
   return res;
 }
 
@@ -305,32 +594,16 @@ static XPLMCursorStatus handleCursor(XPLMWindowID  inWindowID,
                               int           y,
                               void         *inRefcon)
 {
-  (void) inRefcon;
-  PyObject *pID = getPtrRef(inWindowID, windowIDCapsules, windowIDRef);
-  PyObject *pCbks = PyDict_GetItem(windowDict, pID);
-  if(pCbks == NULL){
+  windowCallbackInfo *info = (windowCallbackInfo *)inRefcon;
+  if(info == NULL){
     printf("Unknown window passed to handleCursor (%p).\n", inWindowID);
     return 0;
   }
-  PyObject *cbk = PyTuple_GetItem(pCbks, 3);
-  if((cbk == NULL) || (cbk == Py_None)){
-    return 0;
-  }
-  PyObject *arg1 = PyLong_FromLong(x);
-  PyObject *arg2 = PyLong_FromLong(y);
-  PyObject *pRes = PyObject_CallFunctionObjArgs(cbk, pID, arg1, arg2, inRefcon, NULL);
-  PyObject *err = PyErr_Occurred();
-  Py_DECREF(arg1);
-  Py_DECREF(arg2);
-  Py_DECREF(pID);
-  if(err){
-    PyErr_Print();
-    PyErr_Clear();
+  if(info->handleCursor == Py_None){
     return 0;
   }
-  int res = (int)PyLong_AsLong(pRes);
-  Py_DECREF(pRes);
-  return res;
+  PyObject *args[] = {info->pID, cachedLong(&info->x, x), cachedLong(&info->y, y), info->refcon};
+  return windowCallInt(info, info->handleCursor, args, 4, 0);
 }
 
 static int handleMouseWheel(XPLMWindowID  inWindowID,
@@ -340,38 +613,69 @@ static int handleMouseWheel(XPLMWindowID  inWindowID,
                      int           clicks,
                      void         *inRefcon)
 {
-  (void) inRefcon;
-  PyObject *pID = getPtrRef(inWindowID, windowIDCapsules, windowIDRef);
-  PyObject *pCbks = PyDict_GetItem(windowDict, pID);
-  if(pCbks == NULL){
+  windowCallbackInfo *info = (windowCallbackInfo *)inRefcon;
+  if(info == NULL){
     printf("Unknown window passed to handleMouseWheel (%p).\n", inWindowID);
     return 1;
   }
-  PyObject *cbk = PyTuple_GetItem(pCbks, 4);
-  if((cbk == NULL) || (cbk == Py_None)){
-    return 1;
-  }
-  PyObject *arg1 = PyLong_FromLong(x);
-  PyObject *arg2 = PyLong_FromLong(y);
-  PyObject *arg3 = PyLong_FromLong(wheel);
-  PyObject *arg4 = PyLong_FromLong(clicks);
-  PyObject *pRes = PyObject_CallFunctionObjArgs(cbk, pID, arg1, arg2, arg3, arg4, inRefcon, NULL);
-  PyObject *err = PyErr_Occurred();
-  Py_DECREF(arg1);
-  Py_DECREF(arg2);
-  Py_DECREF(arg3);
-  Py_DECREF(arg4);
-  Py_DECREF(pID);
-  if(err){
-    PyErr_Print();
-    PyErr_Clear();
+  if(info->handleMouseWheel == Py_None){
     return 1;
   }
-  int res = (int)PyLong_AsLong(pRes);
-  Py_DECREF(pRes);
+  PyObject *args[] = {info->pID, cachedLong(&info->x, x), cachedLong(&info->y, y),
+                      PyLong_FromLong(wheel), PyLong_FromLong(clicks), info->refcon};
+  int res = windowCallInt(info, info->handleMouseWheel, args, 6, 1);
+  Py_XDECREF(args[3]);
+  Py_XDECREF(args[4]);
   return res;
 }
 
+static windowCallbackInfo *newWindowCallbackInfo(PyObject *drawWindowFunc, PyObject *handleMouseClickFunc,
+                                                 PyObject *handleKeyFunc, PyObject *handleCursorFunc,
+                                                 PyObject *handleMouseWheelFunc, PyObject *handleRightClickFunc,
+                                                 PyObject *refcon)
+{
+  windowCallbackInfo *info = (windowCallbackInfo *)calloc(1, sizeof(windowCallbackInfo));
+  if(!info){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate window callbacks.");
+    return NULL;
+  }
+  Py_INCREF(drawWindowFunc);
+  info->drawWindow = drawWindowFunc;
+  Py_INCREF(handleMouseClickFunc);
+  info->handleMouseClick = handleMouseClickFunc;
+  Py_INCREF(handleKeyFunc);
+  info->handleKey = handleKeyFunc;
+  Py_INCREF(handleCursorFunc);
+  info->handleCursor = handleCursorFunc;
+  Py_INCREF(handleMouseWheelFunc);
+  info->handleMouseWheel = handleMouseWheelFunc;
+  Py_INCREF(handleRightClickFunc);
+  info->handleRightClick = handleRightClickFunc;
+  Py_INCREF(refcon);
+  info->refcon = refcon;
+  return info;
+}
+
+static PyObject *registerWindow(XPLMWindowID id, windowCallbackInfo *info)
+{
+  info->window = id;
+  info->pID = getPtrRef(id, windowIDCapsules, windowIDRef);
+  PyObject *infoObj = PyLong_FromVoidPtr(info);
+  PyDict_SetItem(windowDict, info->pID, infoObj);
+  Py_DECREF(infoObj);
+  Py_INCREF(info->pID);
+  return info->pID;
+}
+
+static windowCallbackInfo *windowInfoFromObj(PyObject *pID, const char *fun)
+{
+  PyObject *infoObj = PyDict_GetItem(windowDict, pID);
+  if(infoObj == NULL){
+    PyErr_Format(PyExc_RuntimeError, "%s couldn't find the window.\n", fun);
+    return NULL;
+  }
+  return (windowCallbackInfo *)PyLong_AsVoidPtr(infoObj);
+}
 
 static PyObject *XPLMCreateWindowExFun(PyObject *self, PyObject *args)
 {
@@ -382,36 +686,29 @@ static PyObject *XPLMCreateWindowExFun(PyObject *self, PyObject *args)
   }
   
   XPLMCreateWindow_t params;
-  PyObject *drawWindowFunc, *handleMouseClickFunc, *handleKeyFunc,
-           *handleCursorFunc, *handleMouseWheelFunc;
   PyObject *handleRightClickFunc;
   params.structSize = sizeof(params);
   PyObject *paramsTuple = PySequence_Tuple(paramsObj);
+  if(!paramsTuple){
+    return NULL;
+  }
+  if(PyTuple_GET_SIZE(paramsTuple) < 11){
+    Py_DECREF(paramsTuple);
+    PyErr_SetString(PyExc_ValueError, "XPLMCreateWindowEx expects at least 11 parameters.");
+    return NULL;
+  }
   params.left = getLongFromTuple(paramsTuple, 0);
   params.top = getLongFromTuple(paramsTuple, 1);
   params.right = getLongFromTuple(paramsTuple, 2);
   params.bottom = getLongFromTuple(paramsTuple, 3);
   params.visible = getLongFromTuple(paramsTuple, 4);
-  // PySequence_GetItem returns new reference!
-  drawWindowFunc = PyTuple_GetItem(paramsTuple, 5);
-  Py_INCREF(drawWindowFunc);
-  handleMouseClickFunc = PyTuple_GetItem(paramsTuple, 6);
-  Py_INCREF(handleMouseClickFunc);
-  handleKeyFunc = PyTuple_GetItem(paramsTuple, 7);
-  Py_INCREF(handleKeyFunc);
-  handleCursorFunc = PyTuple_GetItem(paramsTuple, 8);
-  Py_INCREF(handleCursorFunc);
-  handleMouseWheelFunc = PyTuple_GetItem(paramsTuple, 9);
-  Py_INCREF(handleMouseWheelFunc);
   params.drawWindowFunc = drawWindow;
   params.handleMouseClickFunc = handleMouseClick;
   params.handleKeyFunc = handleKey;
   params.handleCursorFunc = handleCursor;
   params.handleMouseWheelFunc = handleMouseWheel;
-  params.refcon = PyTuple_GetItem(paramsTuple, 10);
-  Py_INCREF(params.refcon);
   //SDK 3.0+
-  if(PySequence_Length(paramsObj) > 11){
+  if(PyTuple_GET_SIZE(paramsTuple) > 11){
     params.decorateAsFloatingWindow = getLongFromTuple(paramsTuple, 11);
     params.layer = getLongFromTuple(paramsTuple, 12);
     params.handleRightClickFunc = handleRightClick;
@@ -419,21 +716,21 @@ static PyObject *XPLMCreateWindowExFun(PyObject *self, PyObject *args)
   }else{
     handleRightClickFunc = Py_None;
   }
-  Py_INCREF(handleRightClickFunc);
-  
-  PyObject *cbkTuple = Py_BuildValue("(OOOOOO)",
-                                     drawWindowFunc, handleMouseClickFunc, handleKeyFunc,
-                                     handleCursorFunc, handleMouseWheelFunc, handleRightClickFunc);
+  if(PyErr_Occurred()){
+    Py_DECREF(paramsTuple);
+    return NULL;
+  }
+  windowCallbackInfo *info = newWindowCallbackInfo(PyTuple_GET_ITEM(paramsTuple, 5), PyTuple_GET_ITEM(paramsTuple, 6),
+                                                   PyTuple_GET_ITEM(paramsTuple, 7), PyTuple_GET_ITEM(paramsTuple, 8),
+                                                   PyTuple_GET_ITEM(paramsTuple, 9), handleRightClickFunc,
+                                                   PyTuple_GET_ITEM(paramsTuple, 10));
   Py_DECREF(paramsTuple);
-  if(!cbkTuple){
-    PyErr_SetString(PyExc_RuntimeError ,"XPLMCreateWindowEx couldn't create a callback tuple.\n");
+  if(!info){
     return NULL;
   }
+  params.refcon = info;
   XPLMWindowID id = XPLMCreateWindowEx(&params);
-  PyObject *pID = getPtrRef(id, windowIDCapsules, windowIDRef);
-  PyDict_SetItem(windowDict, pID, cbkTuple);
-  Py_DECREF(cbkTuple);
-  return pID;
+  return registerWindow(id, info);
 }
 
 static PyObject *XPLMCreateWindowFun(PyObject *self, PyObject *args)
@@ -445,19 +742,13 @@ static PyObject *XPLMCreateWindowFun(PyObject *self, PyObject *args)
                        &drawCallback, &keyCallback, &mouseCallback, &refcon)){
     return NULL;
   }
-  PyObject *cbkTuple = Py_BuildValue("(OOOOOO)", drawCallback, mouseCallback, keyCallback, Py_None, Py_None, Py_None);
-  if(!cbkTuple){
-    PyErr_SetString(PyExc_RuntimeError ,"XPLMCreateWindow couldn't create a tuple.\n");
+  windowCallbackInfo *info = newWindowCallbackInfo(drawCallback, mouseCallback, keyCallback, Py_None, Py_None, Py_None, refcon);
+  if(!info){
     return NULL;
   }
 
-  Py_INCREF(refcon);
-  XPLMWindowID id = XPLMCreateWindow(left, top, right, bottom, visible, drawWindow, handleKey, handleMouseClick, refcon);
-
-  PyObject *pID = getPtrRef(id, windowIDCapsules, windowIDRef);
-  PyDict_SetItem(windowDict, pID, cbkTuple);
-  Py_DECREF(cbkTuple);
-  return pID;
+  XPLMWindowID id = XPLMCreateWindow(left, top, right, bottom, visible, drawWindow, handleKey, handleMouseClick, info);
+  return registerWindow(id, info);
 }
 
 static PyObject *XPLMDestroyWindowFun(PyObject *self, PyObject *args)
@@ -467,16 +758,13 @@ static PyObject *XPLMDestroyWindowFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "O", &pID)){
     return NULL;
   }
-  if(PyDict_Contains(windowDict, pID)){
-    XPLMWindowID winID = refToPtr(pID, windowIDRef);
-    PyObject *tmp = XPLMGetWindowRefCon(winID);
-    Py_DECREF(tmp);
-    XPLMDestroyWindow(winID);
-    PyDict_DelItem(windowDict, pID);
-  }else{
-    PyErr_SetString(PyExc_RuntimeError ,"XPLMDestroyWindow couldn't find the window to destroy.\n");
+  windowCallbackInfo *info = windowInfoFromObj(pID, "XPLMDestroyWindow");
+  if(!info){
     return NULL;
   }
+  XPLMDestroyWindow(info->window);
+  PyDict_DelItem(windowDict, pID);
+  freeWindowCallbackInfo(info);
   Py_RETURN_NONE;
 }
 
@@ -774,13 +1062,13 @@ static PyObject *XPLMGetWindowRefConFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "O", &win)){
     return NULL;
   }
-  XPLMWindowID inWindowID = refToPtr(win, windowIDRef);
-  PyObject *res = XPLMGetWindowRefCon(inWindowID);
-  // Needs to be done, because python decrefs it when the function
-  //   that called us returns; otherwise all hell breaks loose!!!
-  // TODO: Check no other instance of such a problem lingers in the interface!!!
-  Py_INCREF(res);
-  return res;
+  // the window refcon is our windowCallbackInfo, holding the python refcon
+  windowCallbackInfo *info = windowInfoFromObj(win, "XPLMGetWindowRefCon");
+  if(!info){
+    return NULL;
+  }
+  Py_INCREF(info->refcon);
+  return info->refcon;
 }
 
 static PyObject *XPLMSetWindowRefConFun(PyObject *self, PyObject *args)
@@ -790,13 +1078,14 @@ static PyObject *XPLMSetWindowRefConFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "OO", &win, &inRefcon)){
     return NULL;
   }
-  XPLMWindowID inWindowID = refToPtr(win, windowIDRef);
-  // Decref the old refcon
-  PyObject *tmp = XPLMGetWindowRefCon(inWindowID);
-  Py_DECREF(tmp);
+  windowCallbackInfo *info = windowInfoFromObj(win, "XPLMSetWindowRefCon");
+  if(!info){
+    return NULL;
+  }
   // Make sure it stays with us
   Py_INCREF(inRefcon);
-  XPLMSetWindowRefCon(inWindowID, inRefcon);
+  Py_DECREF(info->refcon);
+  info->refcon = inRefcon;
   Py_RETURN_NONE;
 }
 
@@ -872,7 +1161,9 @@ void hotkeyCallback(void *inRefcon)
     printf("Unknown refcon passed to hotkeyCallback (%p).\n", inRefcon);
     return;
   }
+  traceBegin(traceHotKey, NULL, PyTuple_GetItem(pCbk, 0), inRefcon);
   PyObject *res = PyObject_CallFunctionObjArgs(PyTuple_GetItem(pCbk, 0), PyTuple_GetItem(pCbk, 1), NULL);
+  traceEnd(traceHotKey, inRefcon);
   PyObject *err = PyErr_Occurred();
   Py_XDECREF(res);  // in case hotkey doesn't happent to return anything
   if(err){
@@ -989,8 +1280,29 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
   Py_DECREF(drawCallbackDict);
   PyDict_Clear(drawCallbackIDDict);
   Py_DECREF(drawCallbackIDDict);
+  PyObject *pKey, *pVal;
+  Py_ssize_t pos = 0;
+  while(PyDict_Next(drawListCallbackDict, &pos, &pKey, &pVal)){
+    drawListCallbackInfo *info = (drawListCallbackInfo *)PyLong_AsVoidPtr(pVal);
+    XPLMUnregisterDrawCallback(XPLMDrawListCallback, info->phase, info->wantsBefore, info);
+    freeDrawListCallbackInfo(info);
+  }
+  PyDict_Clear(drawListCallbackDict);
+  Py_DECREF(drawListCallbackDict);
+  pos = 0;
+  while(PyDict_Next(keySniffCallbackDict, &pos, &pKey, &pVal)){
+    keySnifferInfo *info = (keySnifferInfo *)PyLong_AsVoidPtr(pKey);
+    XPLMUnregisterKeySniffer(XPLMKeySnifferCallback, (int)PyLong_AsLong(PyTuple_GetItem(pVal, 2)), info);
+    free(info);
+  }
   PyDict_Clear(keySniffCallbackDict);
   Py_DECREF(keySniffCallbackDict);
+  pos = 0;
+  while(PyDict_Next(windowDict, &pos, &pKey, &pVal)){
+    windowCallbackInfo *info = (windowCallbackInfo *)PyLong_AsVoidPtr(pVal);
+    XPLMDestroyWindow(info->window);
+    freeWindowCallbackInfo(info);
+  }
   PyDict_Clear(windowDict);
   Py_DECREF(windowDict);
   PyDict_Clear(hotkeyDict);
@@ -1008,6 +1320,8 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
 static PyMethodDef XPLMDisplayMethods[] = {
   {"XPLMRegisterDrawCallback", XPLMRegisterDrawCallbackFun, METH_VARARGS, "Register drawing callback."},
   {"XPLMUnregisterDrawCallback", XPLMUnregisterDrawCallbackFun, METH_VARARGS, "Unregister drawing callback."},
+  {"XPLMRegisterDrawListCallback", XPLMRegisterDrawListCallbackFun, METH_VARARGS, "Register drawing callback replaying a draw list."},
+  {"XPLMUnregisterDrawListCallback", XPLMUnregisterDrawListCallbackFun, METH_VARARGS, "Unregister draw list callback."},
   {"XPLMRegisterKeySniffer", XPLMRegisterKeySnifferFun, METH_VARARGS, "Register key sniffer callback."},
   {"XPLMUnregisterKeySniffer", XPLMUnregisterKeySnifferFun, METH_VARARGS, "Unregister key sniffer callback."},
   {"XPLMCreateWindowEx", XPLMCreateWindowExFun, METH_VARARGS, "Create a window (extended interface)."},
@@ -1072,6 +1386,10 @@ PyInit_XPLMDisplay(void)
     return NULL;
   }
   PyDict_SetItemString(xppythonDicts, "drawCallbackIDs", drawCallbackIDDict);
+  if(!(drawListCallbackDict = PyDict_New())){
+    return NULL;
+  }
+  PyDict_SetItemString(xppythonDicts, "drawListCallbacks", drawListCallbackDict);
   if(!(keySniffCallbackDict = PyDict_New())){
     return NULL;
   }
@@ -1197,7 +1515,9 @@ int XPLMDrawCallback(XPLMDrawingPhase inPhase, int inIsBefore, void *inRefcon)
   refcon = PyTuple_GetItem(tup, 4);
   PyObject *inPhaseObj = PyLong_FromLong(inPhase);
   PyObject *inIsBeforeObj = PyLong_FromLong(inIsBefore);
+  traceBegin(traceDraw, PyTuple_GetItem(tup, 0), fun, inRefcon);
   pRes = PyObject_CallFunctionObjArgs(fun, inPhaseObj, inIsBeforeObj, refcon, NULL);
+  traceEnd(traceDraw, inRefcon);
   Py_DECREF(inPhaseObj);
   Py_DECREF(inIsBeforeObj);
   if(!pRes){
@@ -1226,6 +1546,10 @@ int XPLMKeySnifferCallback(char inChar, XPLMKeyFlags inFlags, char inVirtualKey,
   PyObject *tup;
   int res = 1;
 
+  if(!keySnifferWants((keySnifferInfo *)inRefcon, inFlags, inVirtualKey)){
+    // not a key this sniffer asked for: pass it on
+    return 1;
+  }
   pl = PyLong_FromVoidPtr(inRefcon);
   if(pl == NULL){
     printf("Can't create PyLong.");
@@ -1244,7 +1568,9 @@ int XPLMKeySnifferCallback(char inChar, XPLMKeyFlags inFlags, char inVirtualKey,
   PyObject *inFlagsObj = PyLong_FromLong(inFlags);
   PyObject *inVirtualKeyObj = PyLong_FromLong((unsigned int)inVirtualKey);
   refcon = PyTuple_GetItem(tup, 3);
+  traceBegin(traceKeySniffer, PyTuple_GetItem(tup, 0), fun, inRefcon);
   pRes = PyObject_CallFunctionObjArgs(fun, inCharObj, inFlagsObj, inVirtualKeyObj, refcon, NULL);
+  traceEnd(traceKeySniffer, inRefcon);
   Py_DECREF(inCharObj);
   Py_DECREF(inFlagsObj);
   Py_DECREF(inVirtualKeyObj);
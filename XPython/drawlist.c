@@ -0,0 +1,221 @@
+#define _GNU_SOURCE 1
+#include <Python.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#if IBM
+#include <windows.h>
+#endif
+#if APL
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMGraphics.h>
+#include "drawlist.h"
+
+/*
+ * Draw list storage.
+ *
+ * Commands are kept in a single array, strings in a single character buffer
+ * (commands store offsets into it). Clearing a list only resets the counts, so
+ * once a list has grown to its working size, re-recording it allocates nothing.
+ */
+
+const char *drawListRefName = "XPLMDrawListRef";
+
+typedef enum {
+  drawOpString,
+  drawOpNumber,
+  drawOpDarkBox,
+  drawOpRect
+} drawOpType;
+
+typedef struct {
+  drawOpType type;
+  float rgba[4];
+  int x, y;                // left, top for boxes
+  int right, bottom;
+  size_t text;             // offset into drawList.text
+  int wrap;                // 0 means no word wrap
+  int font;
+  double value;
+  int digits, decimals, showSign;
+} drawOp;
+
+struct drawList {
+  drawOp *ops;
+  size_t numOps, maxOps;
+  char *text;
+  size_t textLen, textMax;
+  bool dirty;
+};
+
+static void drawListFree(PyObject *capsule)
+{
+  drawList *list = (drawList *)PyCapsule_GetPointer(capsule, drawListRefName);
+  if(list){
+    free(list->ops);
+    free(list->text);
+    free(list);
+  }
+}
+
+PyObject *drawListNewObj(void)
+{
+  drawList *list = (drawList *)calloc(1, sizeof(drawList));
+  if(!list){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate draw list.");
+    return NULL;
+  }
+  list->dirty = true;
+  PyObject *res = PyCapsule_New(list, drawListRefName, drawListFree);
+  if(!res){
+    free(list);
+  }
+  return res;
+}
+
+drawList *drawListFromObj(PyObject *obj)
+{
+  return (drawList *)PyCapsule_GetPointer(obj, drawListRefName);
+}
+
+void drawListClear(drawList *list)
+{
+  list->numOps = 0;
+  list->textLen = 0;
+}
+
+static drawOp *drawListNewOp(drawList *list, drawOpType type)
+{
+  if(list->numOps == list->maxOps){
+    size_t newMax = list->maxOps ? list->maxOps * 2 : 64;
+    drawOp *ops = (drawOp *)realloc(list->ops, newMax * sizeof(drawOp));
+    if(!ops){
+      return NULL;
+    }
+    list->ops = ops;
+    list->maxOps = newMax;
+  }
+  drawOp *op = &list->ops[list->numOps++];
+  memset(op, 0, sizeof(drawOp));
+  op->type = type;
+  return op;
+}
+
+bool drawListAddString(drawList *list, const float rgb[3], int x, int y, const char *str, int wrap, int font)
+{
+  size_t len = strlen(str) + 1;
+  if(list->textLen + len > list->textMax){
+    size_t newMax = list->textMax ? list->textMax : 1024;
+    while(list->textLen + len > newMax){
+      newMax *= 2;
+    }
+    char *text = (char *)realloc(list->text, newMax);
+    if(!text){
+      return false;
+    }
+    list->text = text;
+    list->textMax = newMax;
+  }
+  drawOp *op = drawListNewOp(list, drawOpString);
+  if(!op){
+    return false;
+  }
+  memcpy(op->rgba, rgb, 3 * sizeof(float));
+  op->x = x;
+  op->y = y;
+  op->text = list->textLen;
+  op->wrap = wrap;
+  op->font = font;
+  memcpy(list->text + list->textLen, str, len);
+  list->textLen += len;
+  return true;
+}
+
+bool drawListAddNumber(drawList *list, const float rgb[3], int x, int y, double value,
+                       int digits, int decimals, int showSign, int font)
+{
+  drawOp *op = drawListNewOp(list, drawOpNumber);
+  if(!op){
+    return false;
+  }
+  memcpy(op->rgba, rgb, 3 * sizeof(float));
+  op->x = x;
+  op->y = y;
+  op->value = value;
+  op->digits = digits;
+  op->decimals = decimals;
+  op->showSign = showSign;
+  op->font = font;
+  return true;
+}
+
+bool drawListAddDarkBox(drawList *list, int left, int top, int right, int bottom)
+{
+  drawOp *op = drawListNewOp(list, drawOpDarkBox);
+  if(!op){
+    return false;
+  }
+  op->x = left;
+  op->y = top;
+  op->right = right;
+  op->bottom = bottom;
+  return true;
+}
+
+bool drawListAddRect(drawList *list, const float rgba[4], int left, int top, int right, int bottom)
+{
+  drawOp *op = drawListNewOp(list, drawOpRect);
+  if(!op){
+    return false;
+  }
+  memcpy(op->rgba, rgba, 4 * sizeof(float));
+  op->x = left;
+  op->y = top;
+  op->right = right;
+  op->bottom = bottom;
+  return true;
+}
+
+void drawListSetDirty(drawList *list, bool dirty)
+{
+  list->dirty = dirty;
+}
+
+bool drawListIsDirty(drawList *list)
+{
+  return list->dirty;
+}
+
+void drawListReplay(drawList *list)
+{
+  for(size_t i = 0; i < list->numOps; ++i){
+    drawOp *op = &list->ops[i];
+    switch(op->type){
+      case drawOpString:
+        XPLMDrawString(op->rgba, op->x, op->y, list->text + op->text, op->wrap ? &op->wrap : NULL, op->font);
+        break;
+      case drawOpNumber:
+        XPLMDrawNumber(op->rgba, op->x, op->y, op->value, op->digits, op->decimals, op->showSign, op->font);
+        break;
+      case drawOpDarkBox:
+        XPLMDrawTranslucentDarkBox(op->x, op->y, op->right, op->bottom);
+        break;
+      case drawOpRect:
+        // no texturing, alpha blending on
+        XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+        glColor4fv(op->rgba);
+        glBegin(GL_QUADS);
+        glVertex2i(op->x, op->y);
+        glVertex2i(op->right, op->y);
+        glVertex2i(op->right, op->bottom);
+        glVertex2i(op->x, op->bottom);
+        glEnd();
+        break;
+    }
+  }
+}
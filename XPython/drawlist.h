@@ -0,0 +1,26 @@
+#ifndef DRAWLIST__H
+#define DRAWLIST__H
+
+#include <Python.h>
+#include <stdbool.h>
+
+/* Retained-mode list of 2d draw commands, recorded from python and
+   replayed from C within a draw callback. */
+typedef struct drawList drawList;
+
+extern const char *drawListRefName;
+
+PyObject *drawListNewObj(void);
+drawList *drawListFromObj(PyObject *obj);
+
+void drawListClear(drawList *list);
+bool drawListAddString(drawList *list, const float rgb[3], int x, int y, const char *str, int wrap, int font);
+bool drawListAddNumber(drawList *list, const float rgb[3], int x, int y, double value,
+                       int digits, int decimals, int showSign, int font);
+bool drawListAddDarkBox(drawList *list, int left, int top, int right, int bottom);
+bool drawListAddRect(drawList *list, const float rgba[4], int left, int top, int right, int bottom);
+void drawListSetDirty(drawList *list, bool dirty);
+bool drawListIsDirty(drawList *list);
+void drawListReplay(drawList *list);
+
+#endif
@@ -6,6 +6,9 @@
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMGraphics.h>
 #include "utils.h"
+#include "drawlist.h"
+#include "textlayout.h"
+#include "texstream.h"
 
 
 static PyObject *XPLMSetGraphicsStateFun(PyObject *self, PyObject *args)
@@ -127,6 +130,58 @@ static PyObject *XPLMLocalToWorldFun(PyObject *self, PyObject *args)
   return res;
 }
 
+typedef void (*coordConversion)(double, double, double, double *, double *, double *);
+
+// Converts {a, b, c} triples from one float64 buffer into another (which may be the same buffer).
+//   The XPLM calls are only valid on the sim's main thread, so the loop runs with the GIL held.
+static PyObject *convertCoordArray(PyObject *args, coordConversion convert, const char *name)
+{
+  PyObject *inObj, *outObj;
+  if(!PyArg_ParseTuple(args, "OO", &inObj, &outObj)){
+    return NULL;
+  }
+  Py_buffer inBuf, outBuf;
+  Py_ssize_t cnt = getTypedBuffer(inObj, &inBuf, 'd', false, name);
+  if(cnt < 0){
+    return NULL;
+  }
+  Py_ssize_t outCnt = getTypedBuffer(outObj, &outBuf, 'd', true, name);
+  if(outCnt < 0){
+    PyBuffer_Release(&inBuf);
+    return NULL;
+  }
+  if(cnt % 3 || outCnt < cnt){
+    PyBuffer_Release(&inBuf);
+    PyBuffer_Release(&outBuf);
+    PyErr_Format(PyExc_ValueError, "%s input must hold 3 doubles per point, output at least as many", name);
+    return NULL;
+  }
+  const double *in = (const double *)inBuf.buf;
+  double *out = (double *)outBuf.buf;
+  double a, b, c;
+  for(Py_ssize_t i = 0; i < cnt; i += 3){
+    a = in[i];
+    b = in[i + 1];
+    c = in[i + 2];
+    convert(a, b, c, &out[i], &out[i + 1], &out[i + 2]);
+  }
+  PyBuffer_Release(&inBuf);
+  PyBuffer_Release(&outBuf);
+  return PyLong_FromSsize_t(cnt / 3);
+}
+
+static PyObject *XPLMWorldToLocalArrayFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  return convertCoordArray(args, XPLMWorldToLocal, "XPLMWorldToLocalArray");
+}
+
+static PyObject *XPLMLocalToWorldArrayFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  return convertCoordArray(args, XPLMLocalToWorld, "XPLMLocalToWorldArray");
+}
+
 static PyObject *XPLMDrawTranslucentDarkBoxFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -239,11 +294,495 @@ static PyObject *XPLMMeasureStringFun(PyObject *self, PyObject *args)
   return PyFloat_FromDouble(XPLMMeasureString(inFontID, inChar, inNumChars));
 }
 
+/* Each row of XPLMDrawStrings items is {x, y, r, g, b, fontID, wordWrapWidth} */
+#define DRAW_STRINGS_COLS 7
+/* Each row of XPLMDrawNumbers items is {x, y, r, g, b, value, digits, decimals, showSign, fontID} */
+#define DRAW_NUMBERS_COLS 10
+
+static PyObject *XPLMDrawStringsFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *itemsObj, *stringsObj;
+  if(!PyArg_ParseTuple(args, "OO", &itemsObj, &stringsObj)){
+    return NULL;
+  }
+  Py_buffer items;
+  Py_ssize_t cnt = getTypedBuffer(itemsObj, &items, 'f', false, "XPLMDrawStrings items");
+  if(cnt < 0){
+    return NULL;
+  }
+  if(cnt % DRAW_STRINGS_COLS){
+    PyBuffer_Release(&items);
+    PyErr_SetString(PyExc_ValueError, "XPLMDrawStrings items must have 7 floats per string");
+    return NULL;
+  }
+  cnt /= DRAW_STRINGS_COLS;
+  const float *row = (const float *)items.buf;
+
+  // Strings are either a sequence of str, or one bytes-like buffer of NUL terminated strings
+  PyObject *seq = NULL;
+  Py_buffer text = {0};
+  const char *textPtr = NULL, *textEnd = NULL;
+  if(PyUnicode_Check(stringsObj) || !PyObject_CheckBuffer(stringsObj)){
+    seq = PySequence_Fast(stringsObj, "XPLMDrawStrings strings must be a sequence of str or a bytes-like object");
+    if(!seq){
+      PyBuffer_Release(&items);
+      return NULL;
+    }
+    if(PySequence_Fast_GET_SIZE(seq) < cnt){
+      PyErr_SetString(PyExc_ValueError, "XPLMDrawStrings has fewer strings than items");
+      goto cleanup;
+    }
+  }else{
+    if(PyObject_GetBuffer(stringsObj, &text, PyBUF_SIMPLE) < 0){
+      goto cleanup;
+    }
+    textPtr = (const char *)text.buf;
+    textEnd = textPtr + text.len;
+  }
+
+  for(Py_ssize_t i = 0; i < cnt; ++i, row += DRAW_STRINGS_COLS){
+    const char *str;
+    if(seq){
+      str = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+      if(!str){
+        goto cleanup;
+      }
+    }else{
+      str = textPtr;
+      const char *nul = memchr(textPtr, '\0', textEnd - textPtr);
+      if(!nul){
+        PyErr_SetString(PyExc_ValueError, "XPLMDrawStrings has fewer NUL terminated strings than items");
+        goto cleanup;
+      }
+      textPtr = nul + 1;
+    }
+    int wordWrapWidth = (int)row[6];
+    XPLMDrawString((float *)&row[2], (int)row[0], (int)row[1], (char *)str,
+                   wordWrapWidth ? &wordWrapWidth : NULL, (int)row[5]);
+  }
+
+ cleanup:
+  Py_XDECREF(seq);
+  if(text.obj){
+    PyBuffer_Release(&text);
+  }
+  PyBuffer_Release(&items);
+  if(PyErr_Occurred()){
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawNumbersFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *itemsObj;
+  if(!PyArg_ParseTuple(args, "O", &itemsObj)){
+    return NULL;
+  }
+  Py_buffer items;
+  Py_ssize_t cnt = getTypedBuffer(itemsObj, &items, 'd', false, "XPLMDrawNumbers items");
+  if(cnt < 0){
+    return NULL;
+  }
+  if(cnt % DRAW_NUMBERS_COLS){
+    PyBuffer_Release(&items);
+    PyErr_SetString(PyExc_ValueError, "XPLMDrawNumbers items must have 10 doubles per number");
+    return NULL;
+  }
+  cnt /= DRAW_NUMBERS_COLS;
+  const double *row = (const double *)items.buf;
+  float inColorRGB[3];
+  for(Py_ssize_t i = 0; i < cnt; ++i, row += DRAW_NUMBERS_COLS){
+    inColorRGB[0] = (float)row[2];
+    inColorRGB[1] = (float)row[3];
+    inColorRGB[2] = (float)row[4];
+    XPLMDrawNumber(inColorRGB, (int)row[0], (int)row[1], row[5], (int)row[6], (int)row[7], (int)row[8], (int)row[9]);
+  }
+  PyBuffer_Release(&items);
+  Py_RETURN_NONE;
+}
+
+static bool colorFromSeq(PyObject *seq, float *outColor, Py_ssize_t count)
+{
+  if(PySequence_Size(seq) != count){
+    PyErr_Format(PyExc_TypeError, "colour must have %zd items", count);
+    return false;
+  }
+  PyObject *tup = PySequence_Tuple(seq);
+  for(Py_ssize_t i = 0; i < count; ++i){
+    outColor[i] = getFloatFromTuple(tup, i);
+  }
+  Py_DECREF(tup);
+  return !PyErr_Occurred();
+}
+
+static drawList *drawListArg(PyObject *obj)
+{
+  drawList *list = drawListFromObj(obj);
+  if(!list){
+    PyErr_SetString(PyExc_TypeError, "expected a draw list created by XPLMCreateDrawList");
+  }
+  return list;
+}
+
+static PyObject *XPLMCreateDrawListFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  (void) args;
+  return drawListNewObj();
+}
+
+static PyObject *XPLMDrawListClearFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj;
+  if(!PyArg_ParseTuple(args, "O", &listObj)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  if(!list){
+    return NULL;
+  }
+  drawListClear(list);
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawListAddStringFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj, *rgbList, *wordWrapWidthObj;
+  int inXOffset, inYOffset, inFontID;
+  const char *inChar;
+  int wordWrapWidth = 0;
+  if(!PyArg_ParseTuple(args, "OOiisOi", &listObj, &rgbList, &inXOffset, &inYOffset, &inChar, &wordWrapWidthObj, &inFontID)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  float inColorRGB[3];
+  if(!list || !colorFromSeq(rgbList, inColorRGB, 3)){
+    return NULL;
+  }
+  if(wordWrapWidthObj != Py_None){
+    wordWrapWidth = PyLong_AsLong(wordWrapWidthObj);
+    if(wordWrapWidth == -1 && PyErr_Occurred()){
+      return NULL;
+    }
+  }
+  if(!drawListAddString(list, inColorRGB, inXOffset, inYOffset, inChar, wordWrapWidth, inFontID)){
+    PyErr_SetString(PyExc_RuntimeError, "Can't grow draw list.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawListAddNumberFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj, *rgbList;
+  int inXOffset, inYOffset, inDigits, inDecimals, inShowSign, inFontID;
+  double inValue;
+  if(!PyArg_ParseTuple(args, "OOiidiiii", &listObj, &rgbList, &inXOffset, &inYOffset, &inValue,
+                       &inDigits, &inDecimals, &inShowSign, &inFontID)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  float inColorRGB[3];
+  if(!list || !colorFromSeq(rgbList, inColorRGB, 3)){
+    return NULL;
+  }
+  if(!drawListAddNumber(list, inColorRGB, inXOffset, inYOffset, inValue, inDigits, inDecimals, inShowSign, inFontID)){
+    PyErr_SetString(PyExc_RuntimeError, "Can't grow draw list.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawListAddTranslucentDarkBoxFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj;
+  int inLeft, inTop, inRight, inBottom;
+  if(!PyArg_ParseTuple(args, "Oiiii", &listObj, &inLeft, &inTop, &inRight, &inBottom)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  if(!list){
+    return NULL;
+  }
+  if(!drawListAddDarkBox(list, inLeft, inTop, inRight, inBottom)){
+    PyErr_SetString(PyExc_RuntimeError, "Can't grow draw list.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawListAddRectFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj, *rgbaList;
+  int inLeft, inTop, inRight, inBottom;
+  if(!PyArg_ParseTuple(args, "OOiiii", &listObj, &rgbaList, &inLeft, &inTop, &inRight, &inBottom)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  float inColorRGBA[4];
+  if(!list || !colorFromSeq(rgbaList, inColorRGBA, 4)){
+    return NULL;
+  }
+  if(!drawListAddRect(list, inColorRGBA, inLeft, inTop, inRight, inBottom)){
+    PyErr_SetString(PyExc_RuntimeError, "Can't grow draw list.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawListSetDirtyFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj;
+  int inDirty = 1;
+  if(!PyArg_ParseTuple(args, "O|i", &listObj, &inDirty)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  if(!list){
+    return NULL;
+  }
+  drawListSetDirty(list, inDirty != 0);
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMDrawDrawListFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *listObj;
+  if(!PyArg_ParseTuple(args, "O", &listObj)){
+    return NULL;
+  }
+  drawList *list = drawListArg(listObj);
+  if(!list){
+    return NULL;
+  }
+  drawListReplay(list);
+  Py_RETURN_NONE;
+}
+
+static textLayout *textLayoutArg(PyObject *text, int inFontID, int wordWrapWidth)
+{
+  if(!PyUnicode_Check(text)){
+    PyErr_SetString(PyExc_TypeError, "text must be a str");
+    return NULL;
+  }
+  return textLayoutGet(text, inFontID, wordWrapWidth);
+}
+
+static PyObject *XPLMMeasureTextLayoutFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *text;
+  int inFontID;
+  int wordWrapWidth = 0;
+  if(!PyArg_ParseTuple(args, "Oi|i", &text, &inFontID, &wordWrapWidth)){
+    return NULL;
+  }
+  textLayout *layout = textLayoutArg(text, inFontID, wordWrapWidth);
+  if(!layout){
+    return NULL;
+  }
+  float width;
+  int lineHeight, numLines;
+  textLayoutExtent(layout, &width, &lineHeight, &numLines);
+  return Py_BuildValue("(fii)", width, lineHeight * numLines, numLines);
+}
+
+static PyObject *XPLMGetTextLayoutLinesFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *text;
+  int inFontID;
+  int wordWrapWidth = 0;
+  if(!PyArg_ParseTuple(args, "Oi|i", &text, &inFontID, &wordWrapWidth)){
+    return NULL;
+  }
+  textLayout *layout = textLayoutArg(text, inFontID, wordWrapWidth);
+  if(!layout){
+    return NULL;
+  }
+  float width;
+  int lineHeight, numLines;
+  textLayoutExtent(layout, &width, &lineHeight, &numLines);
+  PyObject *res = PyList_New(numLines);
+  for(int i = 0; res && i < numLines; ++i){
+    const char *line = textLayoutLine(layout, i, &width);
+    PyObject *item = Py_BuildValue("(sf)", line, width);
+    if(!item){
+      Py_CLEAR(res);
+      break;
+    }
+    PyList_SET_ITEM(res, i, item);
+  }
+  return res;
+}
+
+static PyObject *XPLMDrawTextPanelFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *rgbList, *text;
+  int inLeft, inTop;
+  int wordWrapWidth = 0;
+  int inFontID = xplmFont_Proportional;
+  int lineHeight = 0;
+  if(!PyArg_ParseTuple(args, "OiiO|iii", &rgbList, &inLeft, &inTop, &text, &wordWrapWidth, &inFontID, &lineHeight)){
+    return NULL;
+  }
+  float inColorRGB[3];
+  if(!colorFromSeq(rgbList, inColorRGB, 3)){
+    return NULL;
+  }
+  textLayout *layout = textLayoutArg(text, inFontID, wordWrapWidth);
+  if(!layout){
+    return NULL;
+  }
+  return PyLong_FromLong(textLayoutDraw(layout, inColorRGB, inLeft, inTop, lineHeight));
+}
+
+static PyObject *XPLMTextLayoutCacheConfigureFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  int capacity;
+  if(!PyArg_ParseTuple(args, "i", &capacity)){
+    return NULL;
+  }
+  if(!textLayoutConfigure(capacity)){
+    PyErr_SetString(PyExc_ValueError, "XPLMTextLayoutCacheConfigure requires capacity >= 1.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMTextLayoutCacheGetStatsFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  (void) args;
+  long hits, misses;
+  int size, capacity;
+  textLayoutStats(&hits, &misses, &size, &capacity);
+  return Py_BuildValue("(llii)", hits, misses, size, capacity);
+}
+
+static texStream *texStreamArg(PyObject *obj)
+{
+  texStream *stream = texStreamFromObj(obj);
+  if(!stream){
+    PyErr_SetString(PyExc_TypeError, "expected a texture stream created by XPLMCreateTextureStream");
+  }
+  return stream;
+}
+
+static PyObject *XPLMCreateTextureStreamFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  int textureID, width, height;
+  int format = TEX_STREAM_RGBA8;
+  if(!PyArg_ParseTuple(args, "iii|i", &textureID, &width, &height, &format)){
+    return NULL;
+  }
+  if(width <= 0 || height <= 0){
+    PyErr_SetString(PyExc_ValueError, "XPLMCreateTextureStream requires positive width and height.");
+    return NULL;
+  }
+  if(format != TEX_STREAM_RGBA8 && format != TEX_STREAM_BGRA8){
+    PyErr_SetString(PyExc_ValueError, "XPLMCreateTextureStream format must be xplmTexFormat_RGBA8 or xplmTexFormat_BGRA8.");
+    return NULL;
+  }
+  return texStreamNewObj(textureID, width, height, format);
+}
+
+static PyObject *XPLMTextureStreamWriteFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *streamObj, *pixels;
+  int x = 0, y = 0, width = -1, height = -1;
+  Py_ssize_t stride = 0;
+  if(!PyArg_ParseTuple(args, "OO|iiiin", &streamObj, &pixels, &x, &y, &width, &height, &stride)){
+    return NULL;
+  }
+  texStream *stream = texStreamArg(streamObj);
+  if(!stream){
+    return NULL;
+  }
+  texStage *stage = texStreamStage(stream);
+  if(width < 0){
+    width = stage->width - x;
+  }
+  if(height < 0){
+    height = stage->height - y;
+  }
+  if(stride <= 0){
+    stride = (Py_ssize_t)width * TEX_STAGE_BPP;
+  }else if(stride < (Py_ssize_t)width * TEX_STAGE_BPP){
+    PyErr_SetString(PyExc_ValueError, "XPLMTextureStreamWrite stride is less than a row of pixels.");
+    return NULL;
+  }
+  Py_buffer view;
+  if(PyObject_GetBuffer(pixels, &view, PyBUF_SIMPLE) < 0){
+    return NULL;
+  }
+  bool ok = true;
+  if(width > 0 && height > 0 && view.len < (height - 1) * stride + (Py_ssize_t)width * TEX_STAGE_BPP){
+    PyErr_Format(PyExc_ValueError, "XPLMTextureStreamWrite needs %zd bytes of pixels, buffer has %zd.",
+                 (height - 1) * stride + (Py_ssize_t)width * TEX_STAGE_BPP, view.len);
+    ok = false;
+  }else if(!texStageWrite(stage, (const unsigned char *)view.buf, (size_t)stride, x, y, width, height)){
+    PyErr_SetString(PyExc_ValueError, "XPLMTextureStreamWrite rectangle is outside the texture.");
+    ok = false;
+  }
+  PyBuffer_Release(&view);
+  if(!ok){
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMTextureStreamGetDirtyFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *streamObj;
+  if(!PyArg_ParseTuple(args, "O", &streamObj)){
+    return NULL;
+  }
+  texStream *stream = texStreamArg(streamObj);
+  if(!stream){
+    return NULL;
+  }
+  texRect *dirty = &texStreamStage(stream)->dirty;
+  if(dirty->width == 0){
+    Py_RETURN_NONE;
+  }
+  return Py_BuildValue("(iiii)", dirty->x, dirty->y, dirty->width, dirty->height);
+}
+
+static PyObject *XPLMTextureStreamUploadFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *streamObj;
+  if(!PyArg_ParseTuple(args, "O", &streamObj)){
+    return NULL;
+  }
+  texStream *stream = texStreamArg(streamObj);
+  if(!stream){
+    return NULL;
+  }
+  return PyLong_FromLong(texStreamUpload(stream));
+}
 
 static PyObject *cleanup(PyObject *self, PyObject *args)
 {
   (void) self;
   (void) args;
+  textLayoutCleanup();
   Py_RETURN_NONE;
 }
 
@@ -256,11 +795,32 @@ static PyMethodDef XPLMGraphicsMethods[] = {
 #endif
   {"XPLMWorldToLocal", XPLMWorldToLocalFun, METH_VARARGS, "Transform world coordinates to local."},
   {"XPLMLocalToWorld", XPLMLocalToWorldFun, METH_VARARGS, "Transform local coordinates to world."},
+  {"XPLMWorldToLocalArray", XPLMWorldToLocalArrayFun, METH_VARARGS, "Transform array of world coordinates to local."},
+  {"XPLMLocalToWorldArray", XPLMLocalToWorldArrayFun, METH_VARARGS, "Transform array of local coordinates to world."},
   {"XPLMDrawTranslucentDarkBox", XPLMDrawTranslucentDarkBoxFun, METH_VARARGS, "Draw translucent window."},
   {"XPLMDrawString", XPLMDrawStringFun, METH_VARARGS, "Draw string."},
   {"XPLMDrawNumber", XPLMDrawNumberFun, METH_VARARGS, "Draw number."},
   {"XPLMGetFontDimensions", XPLMGetFontDimensionsFun, METH_VARARGS, "Get fond dimmensions."},
   {"XPLMMeasureString", XPLMMeasureStringFun, METH_VARARGS, "Measure a string."},
+  {"XPLMDrawStrings", XPLMDrawStringsFun, METH_VARARGS, "Draw strings from packed array."},
+  {"XPLMDrawNumbers", XPLMDrawNumbersFun, METH_VARARGS, "Draw numbers from packed array."},
+  {"XPLMCreateDrawList", XPLMCreateDrawListFun, METH_VARARGS, "Create a retained draw list."},
+  {"XPLMDrawListClear", XPLMDrawListClearFun, METH_VARARGS, "Remove all commands from a draw list."},
+  {"XPLMDrawListAddString", XPLMDrawListAddStringFun, METH_VARARGS, "Record string into draw list."},
+  {"XPLMDrawListAddNumber", XPLMDrawListAddNumberFun, METH_VARARGS, "Record number into draw list."},
+  {"XPLMDrawListAddTranslucentDarkBox", XPLMDrawListAddTranslucentDarkBoxFun, METH_VARARGS, "Record translucent window into draw list."},
+  {"XPLMDrawListAddRect", XPLMDrawListAddRectFun, METH_VARARGS, "Record translucent rectangle into draw list."},
+  {"XPLMDrawListSetDirty", XPLMDrawListSetDirtyFun, METH_VARARGS, "Mark draw list as needing to be re-recorded."},
+  {"XPLMDrawDrawList", XPLMDrawDrawListFun, METH_VARARGS, "Draw the commands of a draw list."},
+  {"XPLMMeasureTextLayout", XPLMMeasureTextLayoutFun, METH_VARARGS, "Measure text, with line breaks, using the layout cache."},
+  {"XPLMGetTextLayoutLines", XPLMGetTextLayoutLinesFun, METH_VARARGS, "Get lines of text, using the layout cache."},
+  {"XPLMDrawTextPanel", XPLMDrawTextPanelFun, METH_VARARGS, "Draw multi-line text block, using the layout cache."},
+  {"XPLMTextLayoutCacheConfigure", XPLMTextLayoutCacheConfigureFun, METH_VARARGS, "Set text layout cache capacity."},
+  {"XPLMTextLayoutCacheGetStats", XPLMTextLayoutCacheGetStatsFun, METH_VARARGS, "Get text layout cache statistics."},
+  {"XPLMCreateTextureStream", XPLMCreateTextureStreamFun, METH_VARARGS, "Create a texture updated from python buffers."},
+  {"XPLMTextureStreamWrite", XPLMTextureStreamWriteFun, METH_VARARGS, "Copy pixels into a texture stream."},
+  {"XPLMTextureStreamGetDirty", XPLMTextureStreamGetDirtyFun, METH_VARARGS, "Get rectangle not yet uploaded."},
+  {"XPLMTextureStreamUpload", XPLMTextureStreamUploadFun, METH_VARARGS, "Upload changed pixels to the texture."},
   {"cleanup", cleanup, METH_VARARGS, ""},
   {NULL, NULL, 0, NULL}
 };
@@ -288,6 +848,9 @@ PyInit_XPLMGraphics(void)
     PyModule_AddIntConstant(mod, "xplmFont_Basic", xplmFont_Basic);
      /* Proportional UI font.                                                       */
     PyModule_AddIntConstant(mod, "xplmFont_Proportional", xplmFont_Proportional);
+     /* Pixel formats for XPLMCreateTextureStream                                 */
+    PyModule_AddIntConstant(mod, "xplmTexFormat_RGBA8", TEX_STREAM_RGBA8);
+    PyModule_AddIntConstant(mod, "xplmTexFormat_BGRA8", TEX_STREAM_BGRA8);
   }
 
   return mod;
@@ -2,7 +2,9 @@
 #include <Python.h>
 #include <sys/time.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "plugin_dl.h"
 #include "utils.h"
 #include <XPLM/XPLMDefs.h>
@@ -11,6 +13,56 @@
 
 
 static const char instanceRefName[] = "XPLMInstanceRef";
+static const char instancePoolRefName[] = "XPLMInstancePoolRef";
+
+static void freeDatarefArray(char **datarefs)
+{
+  if(datarefs){
+    for(char **p = datarefs; *p; ++p){
+      free(*p);
+    }
+    free(datarefs);
+  }
+}
+
+// Copies sequence of dataref names into a NULL terminated array, as expected by XPLMCreateInstance.
+//  Returns NULL with exception set on failure; release with freeDatarefArray().
+static char **datarefArray(PyObject *drefList, Py_ssize_t *outLen)
+{
+  PyObject *drefListTuple = PySequence_Tuple(drefList);
+  if(!drefListTuple){
+    return NULL;
+  }
+  Py_ssize_t len = PyTuple_GET_SIZE(drefListTuple);
+  // len + 1, for the NULL terminator
+  char **datarefs = (char **)calloc(len + 1, sizeof(char *));
+  if(datarefs == NULL){
+    Py_DECREF(drefListTuple);
+    PyErr_NoMemory();
+    return NULL;
+  }
+  for(Py_ssize_t i = 0; i < len; ++i){
+    PyObject *s = PyObject_Str(PyTuple_GET_ITEM(drefListTuple, i));
+    const char *tmp = s ? PyUnicode_AsUTF8(s) : NULL;
+    if(tmp){
+      datarefs[i] = strdup(tmp);
+    }
+    Py_XDECREF(s);
+    if(!datarefs[i]){
+      if(!PyErr_Occurred()){
+        PyErr_NoMemory();
+      }
+      Py_DECREF(drefListTuple);
+      freeDatarefArray(datarefs);
+      return NULL;
+    }
+  }
+  Py_DECREF(drefListTuple);
+  if(outLen){
+    *outLen = len;
+  }
+  return datarefs;
+}
 
 static PyObject *XPLMCreateInstanceFun(PyObject *self, PyObject *args)
 {
@@ -23,35 +75,14 @@ static PyObject *XPLMCreateInstanceFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "OO", &obj, &drefList)){
     return NULL;
   }
-  Py_ssize_t len = PySequence_Length(drefList);
-  const char **datarefs = malloc(sizeof(char *) * (len + 1));
+  char **datarefs = datarefArray(drefList, NULL);
   if(datarefs == NULL){
     return NULL;
   }
-  // Malloced len + 1, so we're not overflowing!
-  datarefs[len] = NULL;
-
-  Py_ssize_t i;
-  PyObject *drefListTuple = PySequence_Tuple(drefList);
-  char *tmp;
-  PyObject *tmpObj;
-  for(i = 0; i < len; ++i){
-    PyObject *s = PyObject_Str(PyTuple_GetItem(drefListTuple, i));
-    tmpObj = PyUnicode_AsUTF8String(s);
-    tmp = PyBytes_AsString(tmpObj);
-    Py_DECREF(s);
-    if (PyErr_Occurred()) {
-      Py_DECREF(tmpObj);
-      return NULL;
-    }
-    datarefs[i] = tmp;
-    Py_DECREF(tmpObj);
-  }
-  Py_DECREF(drefListTuple);
   XPLMObjectRef inObj = refToPtr(obj, objRefName);
 
-  XPLMInstanceRef res = XPLMCreateInstance_ptr(inObj, datarefs);
-  free(datarefs);
+  XPLMInstanceRef res = XPLMCreateInstance_ptr(inObj, (const char **)datarefs);
+  freeDatarefArray(datarefs);
   return getPtrRefOneshot(res, instanceRefName);
 }
 
@@ -108,10 +139,379 @@ static PyObject *XPLMInstanceSetPositionFun(PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+static PyObject *XPLMInstanceSetPositionsFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *instances, *positionsObj, *dataObj = Py_None;
+  if(!XPLMInstanceSetPosition_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMInstanceSetPosition is available only in XPLM300 and up.");
+    return NULL;
+  }
+  if(!PyArg_ParseTuple(args, "OO|O", &instances, &positionsObj, &dataObj)){
+    return NULL;
+  }
+  PyObject *instanceSeq = PySequence_Fast(instances, "XPLMInstanceSetPositions instances must be a sequence");
+  if(!instanceSeq){
+    return NULL;
+  }
+  Py_ssize_t cnt = PySequence_Fast_GET_SIZE(instanceSeq);
+  Py_buffer positions, data = {0};
+  Py_ssize_t posLen = getTypedBuffer(positionsObj, &positions, 'f', false, "XPLMInstanceSetPositions positions");
+  if(posLen < 0){
+    Py_DECREF(instanceSeq);
+    return NULL;
+  }
+  Py_ssize_t dataLen = 0;
+  if(dataObj != Py_None){
+    dataLen = getTypedBuffer(dataObj, &data, 'f', false, "XPLMInstanceSetPositions data");
+    if(dataLen < 0){
+      goto cleanup;
+    }
+  }
+  if(posLen != cnt * 6){
+    PyErr_SetString(PyExc_ValueError, "XPLMInstanceSetPositions positions must hold 6 floats per instance");
+    goto cleanup;
+  }
+  if(cnt && dataLen % cnt){
+    PyErr_SetString(PyExc_ValueError, "XPLMInstanceSetPositions data must hold the same number of floats per instance");
+    goto cleanup;
+  }
+  Py_ssize_t stride = cnt ? dataLen / cnt : 0;
+  const float *pos = (const float *)positions.buf;
+  const float *values = (const float *)data.buf;
+  XPLMDrawInfo_t inNewPosition;
+  inNewPosition.structSize = sizeof(XPLMDrawInfo_t);
+  for(Py_ssize_t i = 0; i < cnt; ++i, pos += 6){
+    XPLMInstanceRef inInstance = refToPtr(PySequence_Fast_GET_ITEM(instanceSeq, i), instanceRefName);
+    if(!inInstance){
+      if(!PyErr_Occurred()){
+        PyErr_SetString(PyExc_ValueError, "XPLMInstanceSetPositions instance is None");
+      }
+      goto cleanup;
+    }
+    inNewPosition.x = pos[0];
+    inNewPosition.y = pos[1];
+    inNewPosition.z = pos[2];
+    inNewPosition.pitch = pos[3];
+    inNewPosition.heading = pos[4];
+    inNewPosition.roll = pos[5];
+    XPLMInstanceSetPosition_ptr(inInstance, &inNewPosition, values ? values + i * stride : NULL);
+  }
+
+ cleanup:
+  if(data.obj){
+    PyBuffer_Release(&data);
+  }
+  PyBuffer_Release(&positions);
+  Py_DECREF(instanceSeq);
+  if(PyErr_Occurred()){
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+/*
+ * Instance pools.
+ *
+ * A pool creates instances of one object, with one list of datarefs, and recycles them:
+ * released instances are parked out of view rather than destroyed, and handed out again
+ * by the next acquire. Instances are only destroyed with the pool.
+ */
+
+// Far below any terrain, so parked instances are never seen
+#define INSTANCE_PARK_Y -100000.0f
+
+typedef struct instancePool {
+  XPLMObjectRef obj;
+  char **datarefs;
+  float *parkedData;                // zero values, one per dataref
+  XPLMInstanceRef *instances;       // every instance created by the pool
+  bool *inUse;                      // per instance, acquired and not yet released
+  size_t *available;                // stack of indices of parked instances
+  size_t numInstances, numAvailable, maxInstances;
+  size_t *slots;                    // hash of instance to its index + 1, 0 if empty
+  size_t numSlots;
+  struct instancePool *next;
+} instancePool;
+
+static instancePool *instancePools = NULL;
+
+static size_t instancePoolHash(XPLMInstanceRef instance, size_t numSlots)
+{
+  uintptr_t h = (uintptr_t)instance;
+  h ^= h >> 17;
+  h *= 0x9E3779B1u;
+  h ^= h >> 13;
+  return h & (numSlots - 1);
+}
+
+static void instancePoolInsertSlot(instancePool *pool, size_t idx)
+{
+  size_t h = instancePoolHash(pool->instances[idx], pool->numSlots);
+  while(pool->slots[h]){
+    h = (h + 1) & (pool->numSlots - 1);
+  }
+  pool->slots[h] = idx + 1;
+}
+
+// Returns the index of an instance of this pool, or -1
+static Py_ssize_t instancePoolIndex(instancePool *pool, XPLMInstanceRef instance)
+{
+  if(!pool->numSlots){
+    return -1;
+  }
+  for(size_t h = instancePoolHash(instance, pool->numSlots); pool->slots[h]; h = (h + 1) & (pool->numSlots - 1)){
+    if(pool->instances[pool->slots[h] - 1] == instance){
+      return (Py_ssize_t)(pool->slots[h] - 1);
+    }
+  }
+  return -1;
+}
+
+static void instancePoolDestroyInstances(instancePool *pool)
+{
+  for(size_t i = 0; i < pool->numInstances; ++i){
+    XPLMDestroyInstance_ptr(pool->instances[i]);
+  }
+  pool->numInstances = 0;
+  pool->numAvailable = 0;
+  if(pool->slots){
+    memset(pool->slots, 0, pool->numSlots * sizeof(size_t));
+  }
+}
+
+static void instancePoolFree(PyObject *capsule)
+{
+  instancePool *pool = (instancePool *)PyCapsule_GetPointer(capsule, instancePoolRefName);
+  if(!pool){
+    return;
+  }
+  for(instancePool **link = &instancePools; *link; link = &(*link)->next){
+    if(*link == pool){
+      *link = pool->next;
+      break;
+    }
+  }
+  instancePoolDestroyInstances(pool);
+  freeDatarefArray(pool->datarefs);
+  free(pool->parkedData);
+  free(pool->instances);
+  free(pool->inUse);
+  free(pool->available);
+  free(pool->slots);
+  free(pool);
+}
+
+static void instancePoolPark(instancePool *pool, size_t idx)
+{
+  XPLMDrawInfo_t parked = {sizeof(XPLMDrawInfo_t), 0.0f, INSTANCE_PARK_Y, 0.0f, 0.0f, 0.0f, 0.0f};
+  XPLMInstanceSetPosition_ptr(pool->instances[idx], &parked, pool->parkedData);
+  pool->inUse[idx] = false;
+  pool->available[pool->numAvailable++] = idx;
+}
+
+// Creates a new instance, parked. Returns false with exception set on failure.
+static bool instancePoolGrow(instancePool *pool)
+{
+  if(pool->numInstances == pool->maxInstances){
+    size_t newMax = pool->maxInstances ? pool->maxInstances * 2 : 16;
+    XPLMInstanceRef *instances = (XPLMInstanceRef *)realloc(pool->instances, newMax * sizeof(XPLMInstanceRef));
+    if(instances){
+      pool->instances = instances;
+    }
+    bool *inUse = (bool *)realloc(pool->inUse, newMax * sizeof(bool));
+    if(inUse){
+      pool->inUse = inUse;
+    }
+    size_t *available = (size_t *)realloc(pool->available, newMax * sizeof(size_t));
+    if(available){
+      pool->available = available;
+    }
+    size_t *slots = (size_t *)calloc(newMax * 2, sizeof(size_t));
+    if(!instances || !inUse || !available || !slots){
+      free(slots);
+      PyErr_NoMemory();
+      return false;
+    }
+    free(pool->slots);
+    pool->slots = slots;
+    pool->numSlots = newMax * 2;
+    pool->maxInstances = newMax;
+    for(size_t i = 0; i < pool->numInstances; ++i){
+      instancePoolInsertSlot(pool, i);
+    }
+  }
+  XPLMInstanceRef instance = XPLMCreateInstance_ptr(pool->obj, (const char **)pool->datarefs);
+  if(!instance){
+    PyErr_SetString(PyExc_RuntimeError, "XPLMCreateInstance failed.");
+    return false;
+  }
+  size_t idx = pool->numInstances++;
+  pool->instances[idx] = instance;
+  instancePoolInsertSlot(pool, idx);
+  instancePoolPark(pool, idx);
+  return true;
+}
+
+static instancePool *instancePoolFromObj(PyObject *obj)
+{
+  instancePool *pool = (instancePool *)PyCapsule_GetPointer(obj, instancePoolRefName);
+  if(pool && !pool->datarefs){
+    PyErr_SetString(PyExc_RuntimeError, "Instance pool has been destroyed.");
+    return NULL;
+  }
+  return pool;
+}
+
+static PyObject *XPLMCreateInstancePoolFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *obj, *drefList;
+  int initialCount = 0;
+  if(!XPLMCreateInstance_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMCreateInstancePool is available only in XPLM300 and up.");
+    return NULL;
+  }
+  if(!PyArg_ParseTuple(args, "OO|i", &obj, &drefList, &initialCount)){
+    return NULL;
+  }
+  XPLMObjectRef inObj = refToPtr(obj, objRefName);
+  if(!inObj){
+    if(!PyErr_Occurred()){
+      PyErr_SetString(PyExc_ValueError, "XPLMCreateInstancePool requires an object.");
+    }
+    return NULL;
+  }
+  instancePool *pool = (instancePool *)calloc(1, sizeof(instancePool));
+  if(!pool){
+    return PyErr_NoMemory();
+  }
+  Py_ssize_t numDatarefs = 0;
+  pool->obj = inObj;
+  pool->datarefs = datarefArray(drefList, &numDatarefs);
+  if(!pool->datarefs){
+    free(pool);
+    return NULL;
+  }
+  pool->parkedData = (float *)calloc(numDatarefs + 1, sizeof(float));
+  if(!pool->parkedData){
+    freeDatarefArray(pool->datarefs);
+    free(pool);
+    return PyErr_NoMemory();
+  }
+  PyObject *res = PyCapsule_New(pool, instancePoolRefName, instancePoolFree);
+  if(!res){
+    freeDatarefArray(pool->datarefs);
+    free(pool->parkedData);
+    free(pool);
+    return NULL;
+  }
+  pool->next = instancePools;
+  instancePools = pool;
+  for(int i = 0; i < initialCount; ++i){
+    if(!instancePoolGrow(pool)){
+      Py_DECREF(res);
+      return NULL;
+    }
+  }
+  return res;
+}
+
+static PyObject *XPLMDestroyInstancePoolFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *poolObj;
+  if(!PyArg_ParseTuple(args, "O", &poolObj)){
+    return NULL;
+  }
+  instancePool *pool = instancePoolFromObj(poolObj);
+  if(!pool){
+    return NULL;
+  }
+  instancePoolDestroyInstances(pool);
+  // mark destroyed, remaining memory is released with the capsule
+  freeDatarefArray(pool->datarefs);
+  pool->datarefs = NULL;
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMInstancePoolAcquireFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *poolObj;
+  if(!PyArg_ParseTuple(args, "O", &poolObj)){
+    return NULL;
+  }
+  instancePool *pool = instancePoolFromObj(poolObj);
+  if(!pool){
+    return NULL;
+  }
+  if(pool->numAvailable == 0 && !instancePoolGrow(pool)){
+    return NULL;
+  }
+  size_t idx = pool->available[--pool->numAvailable];
+  pool->inUse[idx] = true;
+  return getPtrRefOneshot(pool->instances[idx], instanceRefName);
+}
+
+static PyObject *XPLMInstancePoolReleaseFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *poolObj, *instance;
+  if(!PyArg_ParseTuple(args, "OO", &poolObj, &instance)){
+    return NULL;
+  }
+  instancePool *pool = instancePoolFromObj(poolObj);
+  if(!pool){
+    return NULL;
+  }
+  XPLMInstanceRef inInstance = refToPtr(instance, instanceRefName);
+  if(!inInstance){
+    if(!PyErr_Occurred()){
+      PyErr_SetString(PyExc_ValueError, "XPLMInstancePoolRelease requires an instance.");
+    }
+    return NULL;
+  }
+  Py_ssize_t idx = instancePoolIndex(pool, inInstance);
+  if(idx < 0){
+    PyErr_SetString(PyExc_ValueError, "XPLMInstancePoolRelease: instance was not acquired from this pool.");
+    return NULL;
+  }
+  if(!pool->inUse[idx]){
+    PyErr_SetString(PyExc_ValueError, "XPLMInstancePoolRelease: instance is already released.");
+    return NULL;
+  }
+  instancePoolPark(pool, (size_t)idx);
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMInstancePoolGetInfoFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *poolObj;
+  if(!PyArg_ParseTuple(args, "O", &poolObj)){
+    return NULL;
+  }
+  instancePool *pool = instancePoolFromObj(poolObj);
+  if(!pool){
+    return NULL;
+  }
+  return Py_BuildValue("(nn)", (Py_ssize_t)pool->numInstances, (Py_ssize_t)pool->numAvailable);
+}
+
 static PyObject *cleanup(PyObject *self, PyObject *args)
 {
   (void) self;
   (void) args;
+  // Instances have to go before the plugin is disabled; pool memory goes with the capsules.
+  //  Pools are left destroyed, as with XPLMDestroyInstancePool, so they can't create more.
+  while(instancePools){
+    instancePool *pool = instancePools;
+    instancePools = pool->next;
+    instancePoolDestroyInstances(pool);
+    freeDatarefArray(pool->datarefs);
+    pool->datarefs = NULL;
+  }
   Py_RETURN_NONE;
 }
 
@@ -119,6 +519,12 @@ static PyMethodDef XPLMInstanceMethods[] = {
   {"XPLMCreateInstance", XPLMCreateInstanceFun, METH_VARARGS, ""},
   {"XPLMDestroyInstance", XPLMDestroyInstanceFun, METH_VARARGS, ""},
   {"XPLMInstanceSetPosition", XPLMInstanceSetPositionFun, METH_VARARGS, ""},
+  {"XPLMInstanceSetPositions", XPLMInstanceSetPositionsFun, METH_VARARGS, ""},
+  {"XPLMCreateInstancePool", XPLMCreateInstancePoolFun, METH_VARARGS, ""},
+  {"XPLMDestroyInstancePool", XPLMDestroyInstancePoolFun, METH_VARARGS, ""},
+  {"XPLMInstancePoolAcquire", XPLMInstancePoolAcquireFun, METH_VARARGS, ""},
+  {"XPLMInstancePoolRelease", XPLMInstancePoolReleaseFun, METH_VARARGS, ""},
+  {"XPLMInstancePoolGetInfo", XPLMInstancePoolGetInfoFun, METH_VARARGS, ""},
   {"cleanup", cleanup, METH_VARARGS, ""},
   {NULL, NULL, 0, NULL}
 };
@@ -7,128 +7,201 @@
 #include <XPLM/XPLMMap.h>
 #include "plugin_dl.h"
 #include "utils.h"
+#include "trace.h"
 
 static PyObject *mapDict;
-intptr_t mapCntr;
 static PyObject *mapRefDict;
 static PyObject *mapCreateDict;
 intptr_t mapCreateCntr;
 PyObject *mapLayerIDCapsules;
-PyObject *mapProjectionCapsule;
 
 static const char layerIDRefName[] = "LayerIdRef";
 static const char projectionRefName[] = "ProjectionRef";
 
+/*
+ * Layer callbacks get the layer's mapLayerInfo as refcon. It keeps the callback
+ * arguments between calls: the map's bounds, zoom and style stay the same while it
+ * isn't being moved, so their python objects are rebuilt only when a value changes.
+ * Each layer has one projection handle, pointing to X-Plane's projection only for the
+ * duration of a callback (X-Plane doesn't promise it's valid any longer than that).
+ */
+
+typedef struct {
+  PyObject *obj;
+  double value;
+} floatCache;
+
+typedef struct {
+  XPLMMapLayerID layer;
+  PyObject *layerObj;         // capsule, set once X-Plane has given us the layer ID
+  PyObject *params;           // tuple passed to XPLMCreateMapLayer, holds the callbacks and refcon
+  PyObject *projectionObj;
+  float bounds[4];
+  PyObject *boundsObj;
+  floatCache zoomRatio, mapUnits, mapStyle;
+} mapLayerInfo;
 
-static inline void mapCallback(int inCallbackIndex, XPLMMapLayerID inLayer, const float *inMapBoundsLeftTopRightBottom, float zoomRatio,
-                        float mapUnitsPerUserInterfaceUnit, XPLMMapStyle mapStyle, XPLMMapProjectionID projection,
-                        void *inRefcon)
+// projection handles point here outside of callbacks
+static char mapProjectionInvalid;
+
+static PyObject *cachedFloat(floatCache *cache, double value)
 {
-  PyObject *layerObj, *boundsObj, *refconObj, *callback;
-  PyObject *ref = PyLong_FromVoidPtr(inRefcon);
-  PyObject *callbackInfo = PyDict_GetItem(mapDict, ref);
+  // borrowed reference
+  if(cache->obj == NULL || cache->value != value){
+    Py_XDECREF(cache->obj);
+    cache->obj = PyFloat_FromDouble(value);
+    cache->value = value;
+  }
+  return cache->obj;
+}
+
+static PyObject *mapBoundsObj(mapLayerInfo *info, const float *inMapBoundsLeftTopRightBottom)
+{
+  // borrowed reference
+  if(info->boundsObj && !memcmp(info->bounds, inMapBoundsLeftTopRightBottom, sizeof(info->bounds))){
+    return info->boundsObj;
+  }
+  Py_CLEAR(info->boundsObj);
+  PyObject *boundsObj = Py_BuildValue("(ffff)", inMapBoundsLeftTopRightBottom[0], inMapBoundsLeftTopRightBottom[1],
+                                      inMapBoundsLeftTopRightBottom[2], inMapBoundsLeftTopRightBottom[3]);
+  if(boundsObj){
+    memcpy(info->bounds, inMapBoundsLeftTopRightBottom, sizeof(info->bounds));
+    info->boundsObj = boundsObj;
+  }
+  return boundsObj;
+}
+
+static PyObject *mapLayerObj(mapLayerInfo *info, XPLMMapLayerID inLayer)
+{
+  // borrowed reference; XPLMCreateMapLayer() calls prep_cache before returning the layer ID
+  if(!info->layerObj){
+    info->layer = inLayer;
+    info->layerObj = getPtrRef(inLayer, mapLayerIDCapsules, layerIDRefName);
+  }
+  return info->layerObj;
+}
+
+static bool mapLayerRegistered(mapLayerInfo *info)
+{
+  PyObject *ref = PyLong_FromVoidPtr(info);
+  int res = PyDict_Contains(mapDict, ref);
   Py_DECREF(ref);
-  if(callbackInfo == NULL){
-    printf("Couldn't find map callback with id = %p.", inRefcon); 
-    return;
+  return res == 1;
+}
+
+static void mapLayerForget(mapLayerInfo *info)
+{
+  // X-Plane is done with the layer: drop our references to it, and free info
+  PyObject *ref = PyLong_FromVoidPtr(info);
+  if(PyDict_DelItem(mapDict, ref)){
+    PyErr_Clear();
   }
+  Py_DECREF(ref);
+  if(info->layerObj){
+    if(PyDict_DelItem(mapRefDict, info->layerObj)){
+      PyErr_Clear();
+    }
+    removePtrRef(info->layer, mapLayerIDCapsules);
+    PyErr_Clear();
+    Py_DECREF(info->layerObj);
+  }
+  Py_DECREF(info->params);
+  Py_XDECREF(info->projectionObj);
+  Py_XDECREF(info->boundsObj);
+  Py_XDECREF(info->zoomRatio.obj);
+  Py_XDECREF(info->mapUnits.obj);
+  Py_XDECREF(info->mapStyle.obj);
+  free(info);
+}
 
-  layerObj = getPtrRef(inLayer, mapLayerIDCapsules, layerIDRefName);
-  mapProjectionCapsule = getPtrRefOneshot(projection, projectionRefName);
-  refconObj = PyTuple_GetItem(callbackInfo, 9);
-  callback = PyTuple_GetItem(callbackInfo, inCallbackIndex);
-  
-  boundsObj = PyTuple_New(4);
-  //Steals the ref!
-  PyTuple_SET_ITEM(boundsObj, 0, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[0]));
-  PyTuple_SET_ITEM(boundsObj, 1, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[1]));
-  PyTuple_SET_ITEM(boundsObj, 2, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[2]));
-  PyTuple_SET_ITEM(boundsObj, 3, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[3]));
-
-  PyObject *zoomRatioObj = PyFloat_FromDouble(zoomRatio);
-  PyObject *mapUnitsPerUserInterfaceUnitObj = PyFloat_FromDouble(mapUnitsPerUserInterfaceUnit);
-  PyObject *mapStyleObj = PyFloat_FromDouble(mapStyle);
-  PyObject *pRes = PyObject_CallFunctionObjArgs(callback, layerObj, boundsObj, zoomRatioObj,
-                                         mapUnitsPerUserInterfaceUnitObj, mapStyleObj, mapProjectionCapsule, refconObj,NULL);
+static void mapCall(PyObject *callback, PyObject *projectionObj, XPLMMapProjectionID projection,
+                    PyObject **args, size_t nargs, void *inRefcon, const char *name)
+{
+  // The callback may destroy the layer (and info), so hold on to the arguments
+  size_t i;
+  for(i = 0; i < nargs; ++i){
+    if(args[i] == NULL){
+      PyErr_Print();
+      return;
+    }
+  }
+  for(i = 0; i < nargs; ++i){
+    Py_INCREF(args[i]);
+  }
+  Py_INCREF(callback);
+  if(projectionObj && projection){
+    PyCapsule_SetPointer(projectionObj, projection);
+  }
+  traceBegin(traceMap, NULL, callback, inRefcon);
+  PyObject *pRes = callVector(callback, args, nargs);
+  traceEnd(traceMap, inRefcon);
   if(!pRes){
-    printf("MapCallback callback failed.\n");
+    printf("%s callback failed.\n", name);
     PyObject *err = PyErr_Occurred();
     if(err){
       PyErr_Print();
     }
   }
-  Py_DECREF(zoomRatioObj);
-  Py_DECREF(mapUnitsPerUserInterfaceUnitObj);
-  Py_DECREF(mapStyleObj);
-  Py_DECREF(boundsObj);
-  Py_DECREF(layerObj);
-  Py_DECREF(mapProjectionCapsule);
-  mapProjectionCapsule = NULL;
+  if(projectionObj){
+    PyCapsule_SetPointer(projectionObj, &mapProjectionInvalid);
+  }
   Py_XDECREF(pRes);
+  Py_DECREF(callback);
+  for(i = 0; i < nargs; ++i){
+    Py_DECREF(args[i]);
+  }
+}
+
+static inline void mapCallback(int inCallbackIndex, XPLMMapLayerID inLayer, const float *inMapBoundsLeftTopRightBottom, float zoomRatio,
+                        float mapUnitsPerUserInterfaceUnit, XPLMMapStyle mapStyle, XPLMMapProjectionID projection,
+                        void *inRefcon)
+{
+  mapLayerInfo *info = (mapLayerInfo *)inRefcon;
+  if(info == NULL){
+    printf("Couldn't find map callback with id = %p.", inRefcon); 
+    return;
+  }
+  PyObject *callback = PyTuple_GET_ITEM(info->params, inCallbackIndex);
+  if(callback == Py_None){
+    return;
+  }
+  PyObject *args[] = {mapLayerObj(info, inLayer), mapBoundsObj(info, inMapBoundsLeftTopRightBottom),
+                      cachedFloat(&info->zoomRatio, zoomRatio), cachedFloat(&info->mapUnits, mapUnitsPerUserInterfaceUnit),
+                      cachedFloat(&info->mapStyle, mapStyle), info->projectionObj, PyTuple_GET_ITEM(info->params, 9)};
+  mapCall(callback, info->projectionObj, projection, args, 7, inRefcon, "MapCallback");
 }
 
 static inline void mapPrepareCacheCallback(XPLMMapLayerID inLayer, const float *inMapBoundsLeftTopRightBottom,
                                            XPLMMapProjectionID projection, void *inRefcon)
 {
-  PyObject *layerObj, *boundsObj, *refconObj, *callback;
-  PyObject *ref = PyLong_FromVoidPtr(inRefcon);
-  PyObject *callbackInfo = PyDict_GetItem(mapDict, ref);
-  Py_DECREF(ref);
-  if(callbackInfo == NULL){
+  mapLayerInfo *info = (mapLayerInfo *)inRefcon;
+  if(info == NULL){
     return;
   }
-
-  layerObj = getPtrRef(inLayer, mapLayerIDCapsules, layerIDRefName);
-  mapProjectionCapsule = getPtrRefOneshot(projection, projectionRefName);
-  refconObj = PyTuple_GetItem(callbackInfo, 9);
-  callback = PyTuple_GetItem(callbackInfo, 3);
-  
-  boundsObj = PyTuple_New(4);
-  PyTuple_SET_ITEM(boundsObj, 0, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[0]));
-  PyTuple_SET_ITEM(boundsObj, 1, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[1]));
-  PyTuple_SET_ITEM(boundsObj, 2, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[2]));
-  PyTuple_SET_ITEM(boundsObj, 3, PyFloat_FromDouble((double)inMapBoundsLeftTopRightBottom[3]));
-
-  PyObject *pRes = PyObject_CallFunctionObjArgs(callback, layerObj, boundsObj, mapProjectionCapsule, refconObj, NULL);
-  if(!pRes){
-    printf("MapPrepareCacheCallback callback failed.\n");
-    PyObject *err = PyErr_Occurred();
-    if(err){
-      PyErr_Print();
-    }
+  PyObject *callback = PyTuple_GET_ITEM(info->params, 3);
+  if(callback == Py_None){
+    return;
   }
-  Py_DECREF(boundsObj);
-  Py_DECREF(layerObj);
-  Py_DECREF(mapProjectionCapsule);
-  mapProjectionCapsule = NULL;
-  Py_XDECREF(pRes);
+  PyObject *args[] = {mapLayerObj(info, inLayer), mapBoundsObj(info, inMapBoundsLeftTopRightBottom),
+                      info->projectionObj, PyTuple_GET_ITEM(info->params, 9)};
+  mapCall(callback, info->projectionObj, projection, args, 4, inRefcon, "MapPrepareCacheCallback");
 }
 
 static inline void mapWillBeDeletedCallback(XPLMMapLayerID inLayer, void *inRefcon)
 {
-  PyObject *layerObj, *refconObj, *callback;
-  PyObject *ref = PyLong_FromVoidPtr(inRefcon);
-  PyObject *callbackInfo = PyDict_GetItem(mapDict, ref);
-  Py_DECREF(ref);
-  if(callbackInfo == NULL){
+  mapLayerInfo *info = (mapLayerInfo *)inRefcon;
+  if(info == NULL){
     printf("Couldn't find map callback with id = %p.", inRefcon); 
     return;
   }
-
-  layerObj = getPtrRef(inLayer, mapLayerIDCapsules, layerIDRefName);
-  refconObj = PyTuple_GetItem(callbackInfo, 9);
-  callback = PyTuple_GetItem(callbackInfo, 2);
-  
-  PyObject *pRes = PyObject_CallFunctionObjArgs(callback, layerObj, refconObj, NULL);
-  if(!pRes){
-    printf("MapWillBeDeletedCallback callback failed.\n");
-    PyObject *err = PyErr_Occurred();
-    if(err){
-      PyErr_Print();
-    }
+  PyObject *callback = PyTuple_GET_ITEM(info->params, 2);
+  if(callback != Py_None){
+    PyObject *args[] = {mapLayerObj(info, inLayer), PyTuple_GET_ITEM(info->params, 9)};
+    mapCall(callback, NULL, NULL, args, 2, inRefcon, "MapWillBeDeletedCallback");
+  }
+  if(mapLayerRegistered(info)){
+    mapLayerForget(info);
   }
-  Py_DECREF(layerObj);
-  Py_XDECREF(pRes);
 }
 
 static inline void mapCreatedCallback(const char *mapIdentifier, void *inRefcon)
@@ -145,7 +218,9 @@ static inline void mapCreatedCallback(const char *mapIdentifier, void *inRefcon)
   callback = PyTuple_GetItem(callbackInfo, 0);
   refconObj = PyTuple_GetItem(callbackInfo, 1);
   
+  traceBegin(traceMap, NULL, callback, inRefcon);
   PyObject *pRes = PyObject_CallFunctionObjArgs(callback, mapIdentifierObj, refconObj, NULL);
+  traceEnd(traceMap, inRefcon);
   if(!pRes){
     printf("mapCreatedCallback callback failed.\n");
     PyObject *err = PyErr_Occurred();
@@ -196,8 +271,15 @@ static PyObject *XPLMCreateMapLayerFun(PyObject *self, PyObject *args)
   }
 
   PyObject *paramsTuple = PySequence_Tuple(params);
+  if(!paramsTuple){
+    return NULL;
+  }
+  if(PyTuple_GET_SIZE(paramsTuple) < 10){
+    PyErr_SetString(PyExc_ValueError, "XPLMCreateMapLayer params must have 10 items.");
+    Py_DECREF(paramsTuple);
+    return NULL;
+  }
 
-  void *ref = (void *)++mapCntr;
   inParams.structSize = sizeof(inParams);
 
   PyObject *tmpObjMap = PyUnicode_AsUTF8String(PyTuple_GetItem(paramsTuple, 0));
@@ -226,24 +308,39 @@ static PyObject *XPLMCreateMapLayerFun(PyObject *self, PyObject *args)
   }
   inParams.layerName = tmpLayerName;
 
-  inParams.refcon = ref;
+  mapLayerInfo *info = (mapLayerInfo *)calloc(1, sizeof(mapLayerInfo));
+  if(!info){
+    Py_DECREF(tmpObjMap);
+    Py_DECREF(tmpObjLayerName);
+    Py_DECREF(paramsTuple);
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate map layer info.");
+    return NULL;
+  }
+  info->params = paramsTuple;
+  Py_INCREF(paramsTuple);
+  info->projectionObj = PyCapsule_New(&mapProjectionInvalid, projectionRefName, NULL);
+  inParams.refcon = info;
 
   /* !!!!
    * XPLMCreateMapLayer() will immediately call prep_cache, so
    * make sure we set mapDict prior to call.
    */
-  PyObject *refObj = PyLong_FromVoidPtr(ref);
+  PyObject *refObj = PyLong_FromVoidPtr(info);
   PyDict_SetItem(mapDict, refObj, paramsTuple);
-  XPLMMapLayerID res = XPLMCreateMapLayer_ptr(&inParams);
+  XPLMMapLayerID res = info->projectionObj ? XPLMCreateMapLayer_ptr(&inParams) : NULL;
   if(!res){
-    PyDict_DelItem(mapDict, refObj);
+    mapLayerForget(info);
     Py_DECREF(refObj);
     Py_DECREF(tmpObjMap);
     Py_DECREF(tmpObjLayerName);
     Py_DECREF(paramsTuple);
+    if(!PyErr_Occurred()){
+      PyErr_SetString(PyExc_RuntimeError, "XPLMCreateMapLayer failed.");
+    }
     return NULL;
   }
-  PyObject *resObj = getPtrRef(res, mapLayerIDCapsules, layerIDRefName);
+  PyObject *resObj = mapLayerObj(info, res);
+  Py_INCREF(resObj);
   PyDict_SetItem(mapRefDict, resObj, refObj);
   Py_DECREF(tmpObjMap);
   Py_DECREF(tmpObjLayerName);
@@ -268,10 +365,11 @@ static PyObject *XPLMDestroyMapLayerFun(PyObject *self, PyObject *args)
   XPLMMapLayerID inLayer = refToPtr(layer, layerIDRefName);
   int res = XPLMDestroyMapLayer_ptr(inLayer);
   if(res){
+    // unless X-Plane already told us, through the layer's willBeDeleted callback
     PyObject *ref = PyDict_GetItem(mapRefDict, layer);
-    PyDict_DelItem(mapDict, ref);
-    PyDict_DelItem(mapRefDict, layer);
-    removePtrRef(inLayer, mapLayerIDCapsules);
+    if(ref){
+      mapLayerForget((mapLayerInfo *)PyLong_AsVoidPtr(ref));
+    }
   }
 
   return PyLong_FromLong(res);
@@ -352,6 +450,19 @@ static PyObject *XPLMDrawMapLabelFun(PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+static XPLMMapProjectionID projectionArg(PyObject *obj)
+{
+  XPLMMapProjectionID projection = refToPtr(obj, projectionRefName);
+  if(projection == (XPLMMapProjectionID)&mapProjectionInvalid){
+    PyErr_SetString(PyExc_RuntimeError, "Map projection is valid only during the map layer callback it was passed to.");
+    return NULL;
+  }
+  if(!projection && !PyErr_Occurred()){
+    PyErr_SetString(PyExc_TypeError, "expected a map projection");
+  }
+  return projection;
+}
+
 static PyObject *XPLMMapProjectFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -365,7 +476,10 @@ static PyObject *XPLMMapProjectFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "Odd", &projectionObj, &latitude, &longitude)) {
     return NULL;
   }
-  XPLMMapProjectionID projection = refToPtr(projectionObj, projectionRefName);
+  XPLMMapProjectionID projection = projectionArg(projectionObj);
+  if(!projection){
+    return NULL;
+  }
   float outX, outY;
   XPLMMapProject_ptr(projection, latitude, longitude, &outX, &outY);
   return Py_BuildValue("ff", outX, outY);
@@ -384,12 +498,257 @@ static PyObject *XPLMMapUnprojectFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "Off", &projectionObj, &mapX, &mapY)){
     return NULL;
   }
-  XPLMMapProjectionID projection = refToPtr(projectionObj, projectionRefName);
+  XPLMMapProjectionID projection = projectionArg(projectionObj);
+  if(!projection){
+    return NULL;
+  }
   double outLongitude, outLatitude;
   XPLMMapUnproject_ptr(projection, mapX, mapY, &outLatitude, &outLongitude);
   return Py_BuildValue("dd", outLatitude, outLongitude);
 }
 
+static PyObject *XPLMMapProjectArrayFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *projectionObj, *inObj, *outObj;
+
+  if(!XPLMMapProject_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMMapProjectArray is available only in XPLM300 and up.");
+    return NULL;
+  }
+  if(!PyArg_ParseTuple(args, "OOO", &projectionObj, &inObj, &outObj)){
+    return NULL;
+  }
+  XPLMMapProjectionID projection = projectionArg(projectionObj);
+  if(!projection){
+    return NULL;
+  }
+  Py_buffer inBuf, outBuf;
+  Py_ssize_t cnt = getTypedBuffer(inObj, &inBuf, 'd', false, "XPLMMapProjectArray");
+  if(cnt < 0){
+    return NULL;
+  }
+  Py_ssize_t outCnt = getTypedBuffer(outObj, &outBuf, 'f', true, "XPLMMapProjectArray");
+  if(outCnt < 0){
+    PyBuffer_Release(&inBuf);
+    return NULL;
+  }
+  if(cnt % 2 || outCnt < cnt){
+    PyBuffer_Release(&inBuf);
+    PyBuffer_Release(&outBuf);
+    PyErr_SetString(PyExc_ValueError, "XPLMMapProjectArray input must hold 2 doubles per point, output as many floats");
+    return NULL;
+  }
+  const double *in = (const double *)inBuf.buf;
+  float *out = (float *)outBuf.buf;
+  for(Py_ssize_t i = 0; i < cnt; i += 2){
+    XPLMMapProject_ptr(projection, in[i], in[i + 1], &out[i], &out[i + 1]);
+  }
+  PyBuffer_Release(&inBuf);
+  PyBuffer_Release(&outBuf);
+  return PyLong_FromSsize_t(cnt / 2);
+}
+
+static PyObject *XPLMMapUnprojectArrayFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *projectionObj, *inObj, *outObj;
+
+  if(!XPLMMapUnproject_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMMapUnprojectArray is available only in XPLM300 and up.");
+    return NULL;
+  }
+  if(!PyArg_ParseTuple(args, "OOO", &projectionObj, &inObj, &outObj)){
+    return NULL;
+  }
+  XPLMMapProjectionID projection = projectionArg(projectionObj);
+  if(!projection){
+    return NULL;
+  }
+  Py_buffer inBuf, outBuf;
+  Py_ssize_t cnt = getTypedBuffer(inObj, &inBuf, 'f', false, "XPLMMapUnprojectArray");
+  if(cnt < 0){
+    return NULL;
+  }
+  Py_ssize_t outCnt = getTypedBuffer(outObj, &outBuf, 'd', true, "XPLMMapUnprojectArray");
+  if(outCnt < 0){
+    PyBuffer_Release(&inBuf);
+    return NULL;
+  }
+  if(cnt % 2 || outCnt < cnt){
+    PyBuffer_Release(&inBuf);
+    PyBuffer_Release(&outBuf);
+    PyErr_SetString(PyExc_ValueError, "XPLMMapUnprojectArray input must hold 2 floats per point, output as many doubles");
+    return NULL;
+  }
+  const float *in = (const float *)inBuf.buf;
+  double *out = (double *)outBuf.buf;
+  for(Py_ssize_t i = 0; i < cnt; i += 2){
+    XPLMMapUnproject_ptr(projection, in[i], in[i + 1], &out[i], &out[i + 1]);
+  }
+  PyBuffer_Release(&inBuf);
+  PyBuffer_Release(&outBuf);
+  return PyLong_FromSsize_t(cnt / 2);
+}
+
+// Icon and label rows start with a position: map x, y, or latitude, longitude
+//  when a projection is passed.
+static void mapItemPosition(XPLMMapProjectionID projection, const double *row, float *mapX, float *mapY)
+{
+  if(projection){
+    XPLMMapProject_ptr(projection, row[0], row[1], mapX, mapY);
+  }else{
+    *mapX = (float)row[0];
+    *mapY = (float)row[1];
+  }
+}
+
+// Optional projection argument of the batch drawing functions: None for map coordinates
+static bool mapItemProjection(PyObject *projectionObj, XPLMMapProjectionID *projection)
+{
+  *projection = NULL;
+  if(projectionObj == NULL || projectionObj == Py_None){
+    return true;
+  }
+  if(!XPLMMapProject_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMMapProject is available only in XPLM300 and up.");
+    return false;
+  }
+  *projection = projectionArg(projectionObj);
+  return *projection != NULL;
+}
+
+#define MAP_ICON_COLS 9
+
+static PyObject *XPLMDrawMapIconsFromSheetFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *layerObj, *itemsObj, *projectionObj = Py_None;
+  const char *inPngPath;
+
+  if(!XPLMDrawMapIconFromSheet_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMDrawMapIconsFromSheet is available only in XPLM300 and up.");
+    return NULL;
+  }
+  if(!PyArg_ParseTuple(args, "OsO|O", &layerObj, &inPngPath, &itemsObj, &projectionObj)){
+    return NULL;
+  }
+  XPLMMapLayerID layer = refToPtr(layerObj, layerIDRefName);
+  XPLMMapProjectionID projection;
+  if(PyErr_Occurred() || !mapItemProjection(projectionObj, &projection)){
+    return NULL;
+  }
+  Py_buffer items;
+  Py_ssize_t cnt = getTypedBuffer(itemsObj, &items, 'd', false, "XPLMDrawMapIconsFromSheet items");
+  if(cnt < 0){
+    return NULL;
+  }
+  if(cnt % MAP_ICON_COLS){
+    PyBuffer_Release(&items);
+    PyErr_SetString(PyExc_ValueError, "XPLMDrawMapIconsFromSheet items must have 9 doubles per icon");
+    return NULL;
+  }
+  cnt /= MAP_ICON_COLS;
+  const double *row = (const double *)items.buf;
+  float mapX, mapY;
+  for(Py_ssize_t i = 0; i < cnt; ++i, row += MAP_ICON_COLS){
+    // x, y, s, t, ds, dt, orientation, rotationDegrees, mapWidth
+    mapItemPosition(projection, row, &mapX, &mapY);
+    XPLMDrawMapIconFromSheet_ptr(layer, inPngPath, (int)row[2], (int)row[3], (int)row[4], (int)row[5], mapX, mapY,
+                                 (XPLMMapOrientation)row[6], (float)row[7], (float)row[8]);
+  }
+  PyBuffer_Release(&items);
+  Py_RETURN_NONE;
+}
+
+#define MAP_LABEL_COLS 4
+
+static PyObject *XPLMDrawMapLabelsFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *layerObj, *itemsObj, *stringsObj, *projectionObj = Py_None;
+
+  if(!XPLMDrawMapLabel_ptr){
+    PyErr_SetString(PyExc_RuntimeError , "XPLMDrawMapLabels is available only in XPLM300 and up.");
+    return NULL;
+  }
+  if(!PyArg_ParseTuple(args, "OOO|O", &layerObj, &itemsObj, &stringsObj, &projectionObj)){
+    return NULL;
+  }
+  XPLMMapLayerID layer = refToPtr(layerObj, layerIDRefName);
+  XPLMMapProjectionID projection;
+  if(PyErr_Occurred() || !mapItemProjection(projectionObj, &projection)){
+    return NULL;
+  }
+  Py_buffer items;
+  Py_ssize_t cnt = getTypedBuffer(itemsObj, &items, 'd', false, "XPLMDrawMapLabels items");
+  if(cnt < 0){
+    return NULL;
+  }
+  if(cnt % MAP_LABEL_COLS){
+    PyBuffer_Release(&items);
+    PyErr_SetString(PyExc_ValueError, "XPLMDrawMapLabels items must have 4 doubles per label");
+    return NULL;
+  }
+  cnt /= MAP_LABEL_COLS;
+  const double *row = (const double *)items.buf;
+
+  // Labels are either a sequence of str, or one bytes-like buffer of NUL terminated strings
+  PyObject *seq = NULL;
+  Py_buffer text = {0};
+  const char *textPtr = NULL, *textEnd = NULL;
+  if(PyUnicode_Check(stringsObj) || !PyObject_CheckBuffer(stringsObj)){
+    seq = PySequence_Fast(stringsObj, "XPLMDrawMapLabels labels must be a sequence of str or a bytes-like object");
+    if(!seq){
+      PyBuffer_Release(&items);
+      return NULL;
+    }
+    if(PySequence_Fast_GET_SIZE(seq) < cnt){
+      PyErr_SetString(PyExc_ValueError, "XPLMDrawMapLabels has fewer labels than items");
+      goto cleanup;
+    }
+  }else{
+    if(PyObject_GetBuffer(stringsObj, &text, PyBUF_SIMPLE) < 0){
+      goto cleanup;
+    }
+    textPtr = (const char *)text.buf;
+    textEnd = textPtr + text.len;
+  }
+
+  float mapX, mapY;
+  for(Py_ssize_t i = 0; i < cnt; ++i, row += MAP_LABEL_COLS){
+    const char *str;
+    if(seq){
+      str = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+      if(!str){
+        goto cleanup;
+      }
+    }else{
+      str = textPtr;
+      const char *nul = textPtr < textEnd ? memchr(textPtr, '\0', textEnd - textPtr) : NULL;
+      if(!nul){
+        PyErr_SetString(PyExc_ValueError, "XPLMDrawMapLabels has fewer NUL terminated labels than items");
+        goto cleanup;
+      }
+      textPtr = nul + 1;
+    }
+    // x, y, orientation, rotationDegrees
+    mapItemPosition(projection, row, &mapX, &mapY);
+    XPLMDrawMapLabel_ptr(layer, str, mapX, mapY, (XPLMMapOrientation)row[2], (float)row[3]);
+  }
+
+ cleanup:
+  Py_XDECREF(seq);
+  if(text.obj){
+    PyBuffer_Release(&text);
+  }
+  PyBuffer_Release(&items);
+  if(PyErr_Occurred()){
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
 static PyObject *XPLMMapScaleMeterFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -403,7 +762,10 @@ static PyObject *XPLMMapScaleMeterFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "Off", &projectionObj, &mapX, &mapY)){
     return NULL;
   }
-  XPLMMapProjectionID projection = refToPtr(projectionObj, projectionRefName);
+  XPLMMapProjectionID projection = projectionArg(projectionObj);
+  if(!projection){
+    return NULL;
+  }
   float res = XPLMMapScaleMeter_ptr(projection, mapX, mapY);
   return PyFloat_FromDouble(res);
 }
@@ -421,7 +783,10 @@ static PyObject *XPLMMapGetNorthHeadingFun(PyObject *self, PyObject *args)
   if(!PyArg_ParseTuple(args, "Off", &projectionObj, &mapX, &mapY)){
     return NULL;
   }
-  XPLMMapProjectionID projection = refToPtr(projectionObj, projectionRefName);
+  XPLMMapProjectionID projection = projectionArg(projectionObj);
+  if(!projection){
+    return NULL;
+  }
   float res = XPLMMapGetNorthHeading_ptr(projection, mapX, mapY);
   return PyFloat_FromDouble(res);
 }
@@ -430,6 +795,21 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
 {
   (void) self;
   (void) args;
+  PyObject *refs = PyDict_Keys(mapDict);
+  for(Py_ssize_t i = 0; refs && i < PyList_GET_SIZE(refs); ++i){
+    PyObject *ref = PyList_GET_ITEM(refs, i);
+    if(PyDict_Contains(mapDict, ref) != 1){
+      continue;
+    }
+    mapLayerInfo *info = (mapLayerInfo *)PyLong_AsVoidPtr(ref);
+    if(info->layer && XPLMDestroyMapLayer_ptr){
+      XPLMDestroyMapLayer_ptr(info->layer);
+    }
+    if(PyDict_Contains(mapDict, ref) == 1){
+      mapLayerForget(info);
+    }
+  }
+  Py_XDECREF(refs);
   PyDict_Clear(mapDict);
   Py_DECREF(mapDict);
   PyDict_Clear(mapRefDict);
@@ -450,6 +830,10 @@ static PyMethodDef XPLMMapMethods[] = {
   {"XPLMDrawMapLabel", XPLMDrawMapLabelFun, METH_VARARGS, ""},
   {"XPLMMapProject", XPLMMapProjectFun, METH_VARARGS, ""},
   {"XPLMMapUnproject", XPLMMapUnprojectFun, METH_VARARGS, ""},
+  {"XPLMMapProjectArray", XPLMMapProjectArrayFun, METH_VARARGS, "Project buffer of latitude, longitude to map coordinates."},
+  {"XPLMMapUnprojectArray", XPLMMapUnprojectArrayFun, METH_VARARGS, "Unproject buffer of map coordinates to latitude, longitude."},
+  {"XPLMDrawMapIconsFromSheet", XPLMDrawMapIconsFromSheetFun, METH_VARARGS, "Draw icons from packed array."},
+  {"XPLMDrawMapLabels", XPLMDrawMapLabelsFun, METH_VARARGS, "Draw labels from packed array."},
   {"XPLMMapScaleMeter", XPLMMapScaleMeterFun, METH_VARARGS, ""},
   {"XPLMMapGetNorthHeading", XPLMMapGetNorthHeadingFun, METH_VARARGS, ""},
   {"cleanup", cleanup, METH_VARARGS, ""},
@@ -6,6 +6,7 @@
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMMenus.h>
 #include "utils.h"
+#include "trace.h"
 #include "plugin_dl.h"
 
 static intptr_t menuCntr;
@@ -24,8 +25,10 @@ static void menuHandler(void * inMenuRef, void * inItemRef)
     printf("Unknown callback requested in menuHandler(%p).\n", inMenuRef);
     return;
   }
+  traceBegin(traceMenu, PyTuple_GetItem(menuCallbackInfo, 0), PyTuple_GetItem(menuCallbackInfo, 4), inMenuRef);
   PyObject *res = PyObject_CallFunctionObjArgs(PyTuple_GetItem(menuCallbackInfo, 4),
                                         PyTuple_GetItem(menuCallbackInfo, 5), (PyObject*)inItemRef, NULL);
+  traceEnd(traceMenu, inMenuRef);
   PyObject *err = PyErr_Occurred();
   if(err){
     printf("Error occured during the menuHandler callback(inMenuRef = %p):\n", inMenuRef);
@@ -0,0 +1,150 @@
+#define _GNU_SOURCE 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMNavigation.h>
+#include <XPLM/XPLMUtilities.h>
+#include "navexport.h"
+
+#define NAV_EXPORT_FORMAT 1
+
+const char *navExportColumnNames[NAV_EXPORT_COLUMNS] = {
+  "ref", "type", "latitude", "longitude", "height", "frequency", "heading", "id", "name"
+};
+const char navExportColumnFormats[NAV_EXPORT_COLUMNS] = {'i', 'i', 'f', 'f', 'f', 'i', 'f', 'I', 'I'};
+
+enum {colRef, colType, colLatitude, colLongitude, colHeight, colFrequency, colHeading, colID, colName};
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len)
+{
+  const unsigned char *p = (const unsigned char *)data;
+  for(size_t i = 0; i < len; ++i){
+    hash = (hash ^ p[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+// There is no navdata version in the SDK, so the key is a fingerprint: sim version, the last
+//  navRef of every navaid type (which changes as soon as the database does) and any user key,
+//  e.g., the AIRAC cycle.
+uint64_t navExportKey(const char *userKey)
+{
+  static const XPLMNavType types[] = {
+    xplm_Nav_Airport, xplm_Nav_NDB, xplm_Nav_VOR, xplm_Nav_ILS, xplm_Nav_Localizer, xplm_Nav_GlideSlope,
+    xplm_Nav_OuterMarker, xplm_Nav_MiddleMarker, xplm_Nav_InnerMarker, xplm_Nav_Fix, xplm_Nav_DME
+  };
+  uint64_t hash = 14695981039346656037ULL;
+  int xplaneVersion, xplmVersion;
+  XPLMHostApplicationID app;
+  XPLMGetVersions(&xplaneVersion, &xplmVersion, &app);
+  hash = fnv1a(hash, &xplaneVersion, sizeof(xplaneVersion));
+  for(size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i){
+    XPLMNavRef last = XPLMFindLastNavAidOfType(types[i]);
+    hash = fnv1a(hash, &last, sizeof(last));
+  }
+  if(userKey){
+    hash = fnv1a(hash, userKey, strlen(userKey));
+  }
+  return hash;
+}
+
+size_t navExportColumnOffset(const navExportHeader *header, int column)
+{
+  return sizeof(navExportHeader) + (size_t)column * header->count * 4;
+}
+
+// Returns malloc'ed export block, or NULL if out of memory.
+void *navExportBuild(uint64_t key, size_t *outSize)
+{
+  uint32_t count = 0, max = 0;
+  uint32_t *columns[NAV_EXPORT_COLUMNS] = {NULL};
+  char *strings = NULL;
+  size_t stringsSize = 0, stringsMax = 0;
+  void *block = NULL;
+  char outID[32];
+  char outName[256];
+
+  for(XPLMNavRef ref = XPLMGetFirstNavAid(); ref != XPLM_NAV_NOT_FOUND; ref = XPLMGetNextNavAid(ref)){
+    if(count == max){
+      max = max ? max * 2 : 16384;
+      for(int c = 0; c < NAV_EXPORT_COLUMNS; ++c){
+        uint32_t *tmp = (uint32_t *)realloc(columns[c], max * sizeof(uint32_t));
+        if(!tmp){
+          goto done;
+        }
+        columns[c] = tmp;
+      }
+    }
+    XPLMNavType outType = xplm_Nav_Unknown;
+    float outLatitude = 0, outLongitude = 0, outHeight = 0, outHeading = 0;
+    int outFrequency = 0;
+    outID[0] = outName[0] = '\0';
+    XPLMGetNavAidInfo(ref, &outType, &outLatitude, &outLongitude, &outHeight, &outFrequency, &outHeading,
+                      outID, outName, NULL);
+    size_t idLen = strnlen(outID, sizeof(outID) - 1) + 1, nameLen = strnlen(outName, sizeof(outName) - 1) + 1;
+    if(stringsSize + idLen + nameLen > stringsMax){
+      stringsMax = stringsMax ? stringsMax * 2 : 1 << 20;
+      char *tmp = (char *)realloc(strings, stringsMax);
+      if(!tmp){
+        goto done;
+      }
+      strings = tmp;
+    }
+    int32_t ints[] = {ref, outType, outFrequency};
+    memcpy(&columns[colRef][count], &ints[0], 4);
+    memcpy(&columns[colType][count], &ints[1], 4);
+    memcpy(&columns[colFrequency][count], &ints[2], 4);
+    memcpy(&columns[colLatitude][count], &outLatitude, 4);
+    memcpy(&columns[colLongitude][count], &outLongitude, 4);
+    memcpy(&columns[colHeight][count], &outHeight, 4);
+    memcpy(&columns[colHeading][count], &outHeading, 4);
+    columns[colID][count] = (uint32_t)stringsSize;
+    memcpy(strings + stringsSize, outID, idLen - 1);
+    strings[stringsSize + idLen - 1] = '\0';
+    stringsSize += idLen;
+    columns[colName][count] = (uint32_t)stringsSize;
+    memcpy(strings + stringsSize, outName, nameLen - 1);
+    strings[stringsSize + nameLen - 1] = '\0';
+    stringsSize += nameLen;
+    ++count;
+  }
+
+  navExportHeader header = {{'X', 'P', 'N', 'V'}, NAV_EXPORT_FORMAT, key, count, (uint32_t)stringsSize};
+  size_t size = navExportColumnOffset(&header, NAV_EXPORT_COLUMNS) + stringsSize;
+  block = malloc(size);
+  if(block){
+    memcpy(block, &header, sizeof(header));
+    for(int c = 0; c < NAV_EXPORT_COLUMNS; ++c){
+      if(count){
+        memcpy((char *)block + navExportColumnOffset(&header, c), columns[c], count * 4);
+      }
+    }
+    if(stringsSize){
+      memcpy((char *)block + navExportColumnOffset(&header, NAV_EXPORT_COLUMNS), strings, stringsSize);
+    }
+    *outSize = size;
+  }
+
+ done:
+  for(int c = 0; c < NAV_EXPORT_COLUMNS; ++c){
+    free(columns[c]);
+  }
+  free(strings);
+  return block;
+}
+
+bool navExportValid(const void *block, size_t size, uint64_t key)
+{
+  if(size < sizeof(navExportHeader)){
+    return false;
+  }
+  navExportHeader header;
+  memcpy(&header, block, sizeof(header));
+  return (!memcmp(header.magic, "XPNV", 4)
+          && header.format == NAV_EXPORT_FORMAT
+          && header.key == key
+          && navExportColumnOffset(&header, NAV_EXPORT_COLUMNS) + header.stringsSize == size);
+}
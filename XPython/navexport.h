@@ -0,0 +1,33 @@
+#ifndef NAVEXPORT__H
+#define NAVEXPORT__H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Columnar export of the whole navaid database.
+
+   The export is a single block: a navExportHeader, then one column of 'count'
+   4-byte values for each of navExportColumnNames (format per navExportColumnFormats),
+   then 'stringsSize' bytes of NUL terminated IDs and names, which the "id" and "name"
+   columns index into. The same block is written to, and mapped from, the cache file. */
+
+#define NAV_EXPORT_COLUMNS 9
+
+typedef struct {
+  char magic[4];         // "XPNV"
+  uint32_t format;
+  uint64_t key;          // navExportKey() of the database the export was made from
+  uint32_t count;
+  uint32_t stringsSize;
+} navExportHeader;
+
+extern const char *navExportColumnNames[NAV_EXPORT_COLUMNS];
+extern const char navExportColumnFormats[NAV_EXPORT_COLUMNS];
+
+uint64_t navExportKey(const char *userKey);
+void *navExportBuild(uint64_t key, size_t *outSize);
+bool navExportValid(const void *block, size_t size, uint64_t key);
+size_t navExportColumnOffset(const navExportHeader *header, int column);
+
+#endif
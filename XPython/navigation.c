@@ -3,10 +3,13 @@
 #include <sys/time.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMNavigation.h>
 #include "utils.h"
 #include "xppythontypes.h"
+#include "navindex.h"
+#include "navexport.h"
 
 static PyObject *XPLMGetFirstNavAidFun(PyObject *self, PyObject *args)
 {
@@ -90,6 +93,247 @@ static PyObject *XPLMGetNavAidInfoFun(PyObject *self, PyObject *args)
   return PyNavAidInfo_New(outType, outLatitude, outLongitude, outHeight, outFrequency, outHeading, outID, outName, (int)outReg[0]);
 }
 
+static PyObject *arrayType = NULL;
+
+// Converts navaid index hits into (array('i') of navRefs, array('d') of distances)
+static PyObject *navIndexHitsToArrays(navIndexHit *hits, int count, bool withDistances)
+{
+  if(count < 0){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate navaid index.");
+    return NULL;
+  }
+  if(!arrayType){
+    PyObject *arrayModule = PyImport_ImportModule("array");
+    if(!arrayModule){
+      return NULL;
+    }
+    arrayType = PyObject_GetAttrString(arrayModule, "array");
+    Py_DECREF(arrayModule);
+    if(!arrayType){
+      return NULL;
+    }
+  }
+  PyObject *refBytes = PyBytes_FromStringAndSize(NULL, count * sizeof(int));
+  PyObject *distBytes = withDistances ? PyBytes_FromStringAndSize(NULL, count * sizeof(double)) : NULL;
+  if(!refBytes || (withDistances && !distBytes)){
+    Py_XDECREF(refBytes);
+    Py_XDECREF(distBytes);
+    return NULL;
+  }
+  int *refs = (int *)PyBytes_AS_STRING(refBytes);
+  double *dists = withDistances ? (double *)PyBytes_AS_STRING(distBytes) : NULL;
+  for(int i = 0; i < count; ++i){
+    refs[i] = hits[i].ref;
+    if(dists){
+      dists[i] = hits[i].distance;
+    }
+  }
+  PyObject *res = PyObject_CallFunction(arrayType, "sO", "i", refBytes);
+  Py_DECREF(refBytes);
+  if(res && withDistances){
+    PyObject *refArray = res;
+    PyObject *distArray = PyObject_CallFunction(arrayType, "sO", "d", distBytes);
+    res = distArray ? PyTuple_Pack(2, refArray, distArray) : NULL;
+    Py_DECREF(refArray);
+    Py_XDECREF(distArray);
+  }
+  Py_XDECREF(distBytes);
+  return res;
+}
+
+static PyObject *XPLMNavIndexRebuildFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  (void)args;
+  int res = navIndexBuild();
+  if(res < 0){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate navaid index.");
+    return NULL;
+  }
+  return PyLong_FromLong(res);
+}
+
+static PyObject *XPLMNavIndexNearestFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  float lat, lon;
+  int count = 1, types = 0;
+  double maxDistance = 0.0;
+  if(!PyArg_ParseTuple(args, "ff|iid", &lat, &lon, &count, &types, &maxDistance)){
+    return NULL;
+  }
+  navIndexHit *hits;
+  int res = navIndexNearest(lat, lon, count, types, maxDistance, &hits);
+  return navIndexHitsToArrays(hits, res, true);
+}
+
+static PyObject *XPLMNavIndexWithinRadiusFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  float lat, lon;
+  double radius;
+  int types = 0;
+  if(!PyArg_ParseTuple(args, "ffd|i", &lat, &lon, &radius, &types)){
+    return NULL;
+  }
+  navIndexHit *hits;
+  int res = navIndexWithinRadius(lat, lon, radius, types, &hits);
+  return navIndexHitsToArrays(hits, res, true);
+}
+
+static PyObject *XPLMNavIndexWithinBoxFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  float south, west, north, east;
+  int types = 0;
+  if(!PyArg_ParseTuple(args, "ffff|i", &south, &west, &north, &east, &types)){
+    return NULL;
+  }
+  navIndexHit *hits;
+  int res = navIndexWithinBox(south, west, north, east, types, &hits);
+  return navIndexHitsToArrays(hits, res, false);
+}
+
+// Wraps a navaid export block (held by a bytes or mmap object) as a dict of memoryview columns
+static PyObject *navExportColumns(PyObject *owner)
+{
+  Py_buffer buf;
+  if(PyObject_GetBuffer(owner, &buf, PyBUF_SIMPLE) < 0){
+    return NULL;
+  }
+  navExportHeader header;
+  memcpy(&header, buf.buf, sizeof(header));
+  PyBuffer_Release(&buf);
+
+  PyObject *view = PyMemoryView_FromObject(owner);
+  PyObject *res = view ? PyDict_New() : NULL;
+  if(!res){
+    Py_XDECREF(view);
+    return NULL;
+  }
+  // numeric columns, then the string table
+  for(int c = 0; c <= NAV_EXPORT_COLUMNS; ++c){
+    Py_ssize_t start = navExportColumnOffset(&header, c);
+    Py_ssize_t end = start + (c < NAV_EXPORT_COLUMNS ? (Py_ssize_t)header.count * 4 : (Py_ssize_t)header.stringsSize);
+    PyObject *col = PySequence_GetSlice(view, start, end);
+    if(col && c < NAV_EXPORT_COLUMNS){
+      char format[2] = {navExportColumnFormats[c], '\0'};
+      PyObject *slice = col;
+      col = PyObject_CallMethod(slice, "cast", "s", format);
+      Py_DECREF(slice);
+    }
+    if(!col || PyDict_SetItemString(res, c < NAV_EXPORT_COLUMNS ? navExportColumnNames[c] : "strings", col)){
+      Py_XDECREF(col);
+      Py_DECREF(res);
+      Py_DECREF(view);
+      return NULL;
+    }
+    Py_DECREF(col);
+  }
+  Py_DECREF(view);
+  return res;
+}
+
+// Maps cache file read-only. Returns the mmap object, or NULL (with no exception set)
+//  if the file is missing or doesn't hold an export matching key.
+static PyObject *navExportLoad(const char *path, uint64_t key)
+{
+  PyObject *mm = NULL;
+  PyObject *ioModule = PyImport_ImportModule("io");
+  PyObject *mmapModule = PyImport_ImportModule("mmap");
+  PyObject *file = ioModule ? PyObject_CallMethod(ioModule, "open", "ss", path, "rb") : NULL;
+  if(file && mmapModule){
+    PyObject *fileno = PyObject_CallMethod(file, "fileno", NULL);
+    PyObject *access = PyObject_GetAttrString(mmapModule, "ACCESS_READ");
+    PyObject *mmapArgs = fileno ? Py_BuildValue("(Oi)", fileno, 0) : NULL;
+    PyObject *mmapKwargs = access ? Py_BuildValue("{s:O}", "access", access) : NULL;
+    PyObject *mmapType = PyObject_GetAttrString(mmapModule, "mmap");
+    if(mmapArgs && mmapKwargs && mmapType){
+      // mmap keeps its own handle, so the file can be closed
+      mm = PyObject_Call(mmapType, mmapArgs, mmapKwargs);
+    }
+    Py_XDECREF(fileno);
+    Py_XDECREF(access);
+    Py_XDECREF(mmapArgs);
+    Py_XDECREF(mmapKwargs);
+    Py_XDECREF(mmapType);
+    PyObject *closed = PyObject_CallMethod(file, "close", NULL);
+    Py_XDECREF(closed);
+  }
+  Py_XDECREF(file);
+  Py_XDECREF(ioModule);
+  Py_XDECREF(mmapModule);
+  if(mm){
+    Py_buffer buf;
+    bool valid = false;
+    if(PyObject_GetBuffer(mm, &buf, PyBUF_SIMPLE) == 0){
+      valid = navExportValid(buf.buf, buf.len, key);
+      PyBuffer_Release(&buf);
+    }
+    if(!valid){
+      PyObject *closed = PyObject_CallMethod(mm, "close", NULL);
+      Py_XDECREF(closed);
+      Py_CLEAR(mm);
+    }
+  }
+  PyErr_Clear();
+  return mm;
+}
+
+static void navExportSave(const char *path, const void *block, size_t size)
+{
+  // write to a temporary file first, so a partially written cache is never mapped
+  size_t len = strlen(path);
+  char *tmpPath = (char *)malloc(len + 5);
+  if(!tmpPath){
+    return;
+  }
+  sprintf(tmpPath, "%s.tmp", path);
+  FILE *f = fopen(tmpPath, "wb");
+  if(f){
+    bool ok = fwrite(block, 1, size, f) == size;
+    ok = (fclose(f) == 0) && ok;
+    if(ok){
+      remove(path);
+      ok = rename(tmpPath, path) == 0;
+    }
+    if(!ok){
+      remove(tmpPath);
+    }
+  }
+  free(tmpPath);
+}
+
+static PyObject *XPLMNavExportFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  const char *cachePath = NULL, *userKey = NULL;
+  if(!PyArg_ParseTuple(args, "|zz", &cachePath, &userKey)){
+    return NULL;
+  }
+  uint64_t key = navExportKey(userKey);
+  PyObject *owner = cachePath ? navExportLoad(cachePath, key) : NULL;
+  if(!owner){
+    size_t size;
+    void *block = navExportBuild(key, &size);
+    if(!block){
+      PyErr_SetString(PyExc_RuntimeError, "Can't allocate navaid export.");
+      return NULL;
+    }
+    if(cachePath){
+      navExportSave(cachePath, block, size);
+    }
+    owner = PyBytes_FromStringAndSize((const char *)block, size);
+    free(block);
+    if(!owner){
+      return NULL;
+    }
+  }
+  PyObject *res = navExportColumns(owner);
+  Py_DECREF(owner);
+  return res;
+}
+
 static PyObject *XPLMCountFMSEntriesFun(PyObject *self, PyObject *args)
 {
   (void)self;
@@ -188,6 +432,99 @@ static PyObject *XPLMClearFMSEntryFun(PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+/* Each FMS entry row of XPLMGetFMSEntries / XPLMSetFMSEntries is {type, navRef, altitude, lat, lon},
+   as doubles. navRef XPLM_NAV_NOT_FOUND is a lat/lon entry. */
+#define FMS_ENTRY_COLS 5
+#define FMS_MAX_ENTRIES 100
+
+static PyObject *XPLMGetFMSEntriesFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  PyObject *entriesObj;
+  if(!PyArg_ParseTuple(args, "O", &entriesObj)){
+    return NULL;
+  }
+  Py_buffer entries;
+  Py_ssize_t len = getTypedBuffer(entriesObj, &entries, 'd', true, "XPLMGetFMSEntries entries");
+  if(len < 0){
+    return NULL;
+  }
+  int count = XPLMCountFMSEntries();
+  if(len < (Py_ssize_t)count * FMS_ENTRY_COLS){
+    PyBuffer_Release(&entries);
+    PyErr_Format(PyExc_ValueError, "XPLMGetFMSEntries entries must hold 5 doubles for each of %d entries", count);
+    return NULL;
+  }
+  double *row = (double *)entries.buf;
+  XPLMNavType outType;
+  XPLMNavRef outRef;
+  int outAltitude;
+  float outLat, outLon;
+  for(int i = 0; i < count; ++i, row += FMS_ENTRY_COLS){
+    XPLMGetFMSEntryInfo(i, &outType, NULL, &outRef, &outAltitude, &outLat, &outLon);
+    row[0] = outType;
+    row[1] = outRef;
+    row[2] = outAltitude;
+    row[3] = outLat;
+    row[4] = outLon;
+  }
+  PyBuffer_Release(&entries);
+  return PyLong_FromLong(count);
+}
+
+static PyObject *XPLMSetFMSEntriesFun(PyObject *self, PyObject *args)
+{
+  (void)self;
+  PyObject *entriesObj;
+  if(!PyArg_ParseTuple(args, "O", &entriesObj)){
+    return NULL;
+  }
+  Py_buffer entries;
+  Py_ssize_t len = getTypedBuffer(entriesObj, &entries, 'd', false, "XPLMSetFMSEntries entries");
+  if(len < 0){
+    return NULL;
+  }
+  if(len % FMS_ENTRY_COLS || len / FMS_ENTRY_COLS > FMS_MAX_ENTRIES){
+    PyBuffer_Release(&entries);
+    PyErr_SetString(PyExc_ValueError, "XPLMSetFMSEntries entries must hold 5 doubles per entry, for at most 100 entries");
+    return NULL;
+  }
+  int count = (int)(len / FMS_ENTRY_COLS);
+  int oldCount = XPLMCountFMSEntries();
+  const double *row = (const double *)entries.buf;
+  XPLMNavType outType;
+  XPLMNavRef outRef;
+  int outAltitude;
+  float outLat, outLon;
+  long changed = 0;
+  // only entries which differ from the current plan are set
+  for(int i = 0; i < count; ++i, row += FMS_ENTRY_COLS){
+    XPLMNavRef inRef = (XPLMNavRef)row[1];
+    int inAltitude = (int)row[2];
+    float inLat = (float)row[3], inLon = (float)row[4];
+    bool current = i < oldCount;
+    if(current){
+      XPLMGetFMSEntryInfo(i, &outType, NULL, &outRef, &outAltitude, &outLat, &outLon);
+    }
+    if(inRef == XPLM_NAV_NOT_FOUND){
+      if(!current || outRef != XPLM_NAV_NOT_FOUND || outAltitude != inAltitude || outLat != inLat || outLon != inLon){
+        XPLMSetFMSEntryLatLon(i, inLat, inLon, inAltitude);
+        ++changed;
+      }
+    }else if(!current || outRef != inRef || outAltitude != inAltitude){
+      XPLMSetFMSEntryInfo(i, inRef, inAltitude);
+      ++changed;
+    }
+  }
+  // shorten the plan, from the end
+  for(int i = oldCount - 1; i >= count; --i){
+    XPLMClearFMSEntry(i);
+    ++changed;
+  }
+  PyBuffer_Release(&entries);
+  return PyLong_FromLong(changed);
+}
+
 static PyObject *XPLMGetGPSDestinationTypeFun(PyObject *self, PyObject *args)
 {
   (void)self;
@@ -206,6 +543,8 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
 {
   (void) self;
   (void) args;
+  navIndexCleanup();
+  Py_CLEAR(arrayType);
   Py_RETURN_NONE;
 }
 
@@ -216,6 +555,11 @@ static PyMethodDef XPLMNavigationMethods[] = {
   {"XPLMFindLastNavAidOfType", XPLMFindLastNavAidOfTypeFun, METH_VARARGS, ""},
   {"XPLMFindNavAid", XPLMFindNavAidFun, METH_VARARGS, ""},
   {"XPLMGetNavAidInfo", XPLMGetNavAidInfoFun, METH_VARARGS, ""},
+  {"XPLMNavIndexRebuild", XPLMNavIndexRebuildFun, METH_VARARGS, ""},
+  {"XPLMNavIndexNearest", XPLMNavIndexNearestFun, METH_VARARGS, ""},
+  {"XPLMNavIndexWithinRadius", XPLMNavIndexWithinRadiusFun, METH_VARARGS, ""},
+  {"XPLMNavIndexWithinBox", XPLMNavIndexWithinBoxFun, METH_VARARGS, ""},
+  {"XPLMNavExport", XPLMNavExportFun, METH_VARARGS, ""},
   {"XPLMCountFMSEntries", XPLMCountFMSEntriesFun, METH_VARARGS, ""},
   {"XPLMGetDisplayedFMSEntry", XPLMGetDisplayedFMSEntryFun, METH_VARARGS, ""},
   {"XPLMGetDestinationFMSEntry", XPLMGetDestinationFMSEntryFun, METH_VARARGS, ""},
@@ -225,6 +569,8 @@ static PyMethodDef XPLMNavigationMethods[] = {
   {"XPLMSetFMSEntryInfo", XPLMSetFMSEntryInfoFun, METH_VARARGS, ""},
   {"XPLMSetFMSEntryLatLon", XPLMSetFMSEntryLatLonFun, METH_VARARGS, ""},
   {"XPLMClearFMSEntry", XPLMClearFMSEntryFun, METH_VARARGS, ""},
+  {"XPLMGetFMSEntries", XPLMGetFMSEntriesFun, METH_VARARGS, ""},
+  {"XPLMSetFMSEntries", XPLMSetFMSEntriesFun, METH_VARARGS, ""},
   {"XPLMGetGPSDestinationType", XPLMGetGPSDestinationTypeFun, METH_VARARGS, ""},
   {"XPLMGetGPSDestination", XPLMGetGPSDestinationFun, METH_VARARGS, ""},
   {"cleanup", cleanup, METH_VARARGS, ""},
@@ -0,0 +1,279 @@
+#define _GNU_SOURCE 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMNavigation.h>
+#include "navindex.h"
+
+/*
+ * Navaid spatial index.
+ *
+ * The navaid database is walked once (XPLMGetFirstNavAid / XPLMGetNextNavAid) and each
+ * entry's position stored, sorted into 1 degree lat/lon cells. Queries visit only the
+ * cells overlapping the search area, and compare unit vectors to find great-circle
+ * distances. The snapshot is marked stale when scenery is reloaded, and rebuilt on the
+ * next query.
+ */
+
+#define NAV_EARTH_RADIUS_NM 3440.065
+#define NAV_LAT_CELLS 180
+#define NAV_LON_CELLS 360
+#define NAV_CELLS (NAV_LAT_CELLS * NAV_LON_CELLS)
+
+typedef struct {
+  XPLMNavRef ref;
+  XPLMNavType type;
+  float lat, lon;
+  double v[3];        // unit vector
+} navEntry;
+
+static navEntry *navEntries = NULL;
+static int navCount;
+static int *navCellStart = NULL;    // entries of cell c are [navCellStart[c], navCellStart[c + 1])
+static bool navValid = false;
+
+static navIndexHit *navHits = NULL;
+static int navHitCount, navHitMax;
+
+static void navUnitVector(double lat, double lon, double *v)
+{
+  double la = lat * M_PI / 180.0, lo = lon * M_PI / 180.0;
+  v[0] = cos(la) * cos(lo);
+  v[1] = cos(la) * sin(lo);
+  v[2] = sin(la);
+}
+
+static int navLatCell(double lat)
+{
+  int c = (int)floor(lat + 90.0);
+  return c < 0 ? 0 : (c >= NAV_LAT_CELLS ? NAV_LAT_CELLS - 1 : c);
+}
+
+static int navLonCell(double lon)
+{
+  int c = (int)floor(lon + 180.0) % NAV_LON_CELLS;
+  return c < 0 ? c + NAV_LON_CELLS : c;
+}
+
+int navIndexBuild(void)
+{
+  int count = 0, max = 0;
+  navEntry *entries = NULL;
+  for(XPLMNavRef ref = XPLMGetFirstNavAid(); ref != XPLM_NAV_NOT_FOUND; ref = XPLMGetNextNavAid(ref)){
+    if(count == max){
+      max = max ? max * 2 : 16384;
+      navEntry *tmp = (navEntry *)realloc(entries, max * sizeof(navEntry));
+      if(!tmp){
+        free(entries);
+        return -1;
+      }
+      entries = tmp;
+    }
+    navEntry *e = &entries[count++];
+    e->ref = ref;
+    XPLMGetNavAidInfo(ref, &e->type, &e->lat, &e->lon, NULL, NULL, NULL, NULL, NULL, NULL);
+    navUnitVector(e->lat, e->lon, e->v);
+  }
+
+  // counting sort into cells
+  int *cellStart = (int *)calloc(NAV_CELLS + 1, sizeof(int));
+  navEntry *sorted = (navEntry *)malloc((count ? count : 1) * sizeof(navEntry));
+  if(!cellStart || !sorted){
+    free(entries);
+    free(cellStart);
+    free(sorted);
+    return -1;
+  }
+  for(int i = 0; i < count; ++i){
+    ++cellStart[navLatCell(entries[i].lat) * NAV_LON_CELLS + navLonCell(entries[i].lon) + 1];
+  }
+  for(int c = 0; c < NAV_CELLS; ++c){
+    cellStart[c + 1] += cellStart[c];
+  }
+  for(int i = 0; i < count; ++i){
+    int c = navLatCell(entries[i].lat) * NAV_LON_CELLS + navLonCell(entries[i].lon);
+    // cellStart[c] is used as fill position, and restored below
+    sorted[cellStart[c]++] = entries[i];
+  }
+  for(int c = NAV_CELLS; c > 0; --c){
+    cellStart[c] = cellStart[c - 1];
+  }
+  cellStart[0] = 0;
+  free(entries);
+
+  free(navEntries);
+  free(navCellStart);
+  navEntries = sorted;
+  navCellStart = cellStart;
+  navCount = count;
+  navValid = true;
+  return count;
+}
+
+void navIndexInvalidate(void)
+{
+  navValid = false;
+}
+
+void navIndexCleanup(void)
+{
+  free(navEntries);
+  free(navCellStart);
+  free(navHits);
+  navEntries = NULL;
+  navCellStart = NULL;
+  navHits = NULL;
+  navCount = navHitCount = navHitMax = 0;
+  navValid = false;
+}
+
+static bool navAddHit(XPLMNavRef ref, double distance)
+{
+  if(navHitCount == navHitMax){
+    int newMax = navHitMax ? navHitMax * 2 : 256;
+    navIndexHit *tmp = (navIndexHit *)realloc(navHits, newMax * sizeof(navIndexHit));
+    if(!tmp){
+      return false;
+    }
+    navHits = tmp;
+    navHitMax = newMax;
+  }
+  navHits[navHitCount].ref = ref;
+  navHits[navHitCount].distance = distance;
+  ++navHitCount;
+  return true;
+}
+
+static int navCompareHits(const void *a, const void *b)
+{
+  double da = ((const navIndexHit *)a)->distance, db = ((const navIndexHit *)b)->distance;
+  return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+// Adds entries of the given cell range within 'radius' of unit vector v to the hits.
+static bool navScanCells(int latCell, int lonFirst, int lonCount, const double *v, double minDot,
+                         int typeMask, double radius)
+{
+  for(int i = 0; i < lonCount; ++i){
+    int c = latCell * NAV_LON_CELLS + (lonFirst + i) % NAV_LON_CELLS;
+    for(int k = navCellStart[c]; k < navCellStart[c + 1]; ++k){
+      navEntry *e = &navEntries[k];
+      if(typeMask && !(e->type & typeMask)){
+        continue;
+      }
+      double dot = e->v[0] * v[0] + e->v[1] * v[1] + e->v[2] * v[2];
+      if(dot >= minDot){
+        double d = acos(dot > 1.0 ? 1.0 : dot) * NAV_EARTH_RADIUS_NM;
+        if(d <= radius && !navAddHit(e->ref, d)){
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+static int navRadiusQuery(float lat, float lon, double radius, int typeMask)
+{
+  navHitCount = 0;
+  double v[3];
+  navUnitVector(lat, lon, v);
+  double angle = radius / NAV_EARTH_RADIUS_NM;            // radians
+  double minDot = angle >= M_PI ? -2.0 : cos(angle);
+  double latMin = lat - angle * 180.0 / M_PI, latMax = lat + angle * 180.0 / M_PI;
+  int lonFirst = 0, lonCount = NAV_LON_CELLS;
+  if(latMin > -90.0 && latMax < 90.0){
+    double s = sin(angle) / cos(lat * M_PI / 180.0);
+    if(s < 1.0){
+      double span = asin(s) * 180.0 / M_PI;
+      lonFirst = navLonCell(lon - span);
+      lonCount = (int)floor(lon + span + 180.0) - (int)floor(lon - span + 180.0) + 1;
+      if(lonCount > NAV_LON_CELLS){
+        lonCount = NAV_LON_CELLS;
+      }
+    }
+  }
+  for(int la = navLatCell(latMin); la <= navLatCell(latMax); ++la){
+    if(!navScanCells(la, lonFirst, lonCount, v, minDot, typeMask, radius)){
+      return -1;
+    }
+  }
+  qsort(navHits, navHitCount, sizeof(navIndexHit), navCompareHits);
+  return navHitCount;
+}
+
+int navIndexWithinRadius(float lat, float lon, double radius, int typeMask, navIndexHit **outHits)
+{
+  if(!navValid && navIndexBuild() < 0){
+    return -1;
+  }
+  int res = navRadiusQuery(lat, lon, radius, typeMask);
+  *outHits = navHits;
+  return res;
+}
+
+int navIndexNearest(float lat, float lon, int count, int typeMask, double maxDistance, navIndexHit **outHits)
+{
+  if(!navValid && navIndexBuild() < 0){
+    return -1;
+  }
+  // widen the search until it holds enough navaids: everything within the radius has been
+  //  seen, so the closest 'count' hits are the nearest navaids.
+  double halfCircumference = M_PI * NAV_EARTH_RADIUS_NM;
+  double limit = maxDistance > 0.0 ? maxDistance : halfCircumference;
+  double radius = limit < 50.0 ? limit : 50.0;
+  int res;
+  while(1){
+    res = navRadiusQuery(lat, lon, radius, typeMask);
+    if(res < 0 || res >= count || radius >= limit){
+      break;
+    }
+    radius = radius * 4.0 < limit ? radius * 4.0 : limit;
+  }
+  *outHits = navHits;
+  return res < 0 ? res : (res < count ? res : count);
+}
+
+int navIndexWithinBox(float south, float west, float north, float east, int typeMask, navIndexHit **outHits)
+{
+  if(!navValid && navIndexBuild() < 0){
+    return -1;
+  }
+  navHitCount = 0;
+  *outHits = navHits;
+  if(south > north){
+    return 0;
+  }
+  // west > east means the box crosses the antimeridian
+  bool wraps = west > east;
+  int lonFirst = navLonCell(west);
+  int lonCount = (wraps ? navLonCell(east) + NAV_LON_CELLS : (int)floor(east + 180.0)) - lonFirst + 1;
+  if(lonCount > NAV_LON_CELLS){
+    lonCount = NAV_LON_CELLS;
+  }
+  for(int la = navLatCell(south); la <= navLatCell(north); ++la){
+    for(int i = 0; i < lonCount; ++i){
+      int c = la * NAV_LON_CELLS + (lonFirst + i) % NAV_LON_CELLS;
+      for(int k = navCellStart[c]; k < navCellStart[c + 1]; ++k){
+        navEntry *e = &navEntries[k];
+        if(typeMask && !(e->type & typeMask)){
+          continue;
+        }
+        if(e->lat < south || e->lat > north){
+          continue;
+        }
+        if(wraps ? (e->lon < west && e->lon > east) : (e->lon < west || e->lon > east)){
+          continue;
+        }
+        if(!navAddHit(e->ref, 0.0)){
+          return -1;
+        }
+      }
+    }
+  }
+  *outHits = navHits;
+  return navHitCount;
+}
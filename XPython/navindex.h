@@ -0,0 +1,25 @@
+#ifndef NAVINDEX__H
+#define NAVINDEX__H
+
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMNavigation.h>
+
+/* Snapshot of the navaid database, bucketed on a lat/lon grid for spatial queries. */
+
+typedef struct {
+  XPLMNavRef ref;
+  double distance;    // nautical miles from the query point (0 for box queries)
+} navIndexHit;
+
+int navIndexBuild(void);
+void navIndexInvalidate(void);
+void navIndexCleanup(void);
+
+// Queries build the snapshot if needed, and return the number of hits. Hits are kept
+//  in a buffer owned by the index, valid until the next query.
+int navIndexNearest(float lat, float lon, int count, int typeMask, double maxDistance, navIndexHit **outHits);
+int navIndexWithinRadius(float lat, float lon, double radius, int typeMask, navIndexHit **outHits);
+int navIndexWithinBox(float south, float west, float north, float east, int typeMask, navIndexHit **outHits);
+
+#endif
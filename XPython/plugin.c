@@ -13,6 +13,9 @@
 
 #include "utils.h"
 #include "plugin_dl.h"
+#include "trace.h"
+#include "terraincache.h"
+#include "navindex.h"
 
 /*************************************
  * Python plugin upgrade for Python 3
@@ -40,10 +43,15 @@ static const char *pythonPluginDesc = "X-Plane interface for Python 3";
 static const char *pythonDisableCommand = "XPPython3/disableScripts";
 static const char *pythonEnableCommand = "XPPython3/enableScripts";
 static const char *pythonReloadCommand = "XPPython3/reloadScripts";
+static const char *pythonTraceStartCommand = "XPPython3/startTrace";
+static const char *pythonTraceDumpCommand = "XPPython3/dumpTrace";
+static const char *traceFileName = "XPPython3_trace.json";
 /**********************/
 static XPLMCommandRef disableScripts;
 static XPLMCommandRef enableScripts;
 static XPLMCommandRef reloadScripts;
+static XPLMCommandRef startTrace;
+static XPLMCommandRef dumpTrace;
 
 static int commandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 
@@ -444,10 +452,14 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
   disableScripts = XPLMCreateCommand(pythonDisableCommand, "Disable all running scripts");
   enableScripts = XPLMCreateCommand(pythonEnableCommand, "Enable all scripts");
   reloadScripts = XPLMCreateCommand(pythonReloadCommand, "Reload all scripts");
+  startTrace = XPLMCreateCommand(pythonTraceStartCommand, "Start tracing python callbacks");
+  dumpTrace = XPLMCreateCommand(pythonTraceDumpCommand, "Stop tracing python callbacks and write trace file");
 
   XPLMRegisterCommandHandler(disableScripts, commandHandler, 1, (void *)0);
   XPLMRegisterCommandHandler(enableScripts, commandHandler, 1, (void *)1);
   XPLMRegisterCommandHandler(reloadScripts, commandHandler, 1, (void *)2);
+  XPLMRegisterCommandHandler(startTrace, commandHandler, 1, (void *)3);
+  XPLMRegisterCommandHandler(dumpTrace, commandHandler, 1, (void *)4);
 
   if(startPython() == -1) {
     fprintf(pythonLogFile, "Failed to start python, exiting.\n");
@@ -464,6 +476,8 @@ PLUGIN_API void XPluginStop(void)
   XPLMUnregisterCommandHandler(disableScripts, commandHandler, 1, (void *)0);
   XPLMUnregisterCommandHandler(enableScripts, commandHandler, 1, (void *)1);
   XPLMUnregisterCommandHandler(reloadScripts, commandHandler, 1, (void *)2);
+  XPLMUnregisterCommandHandler(startTrace, commandHandler, 1, (void *)3);
+  XPLMUnregisterCommandHandler(dumpTrace, commandHandler, 1, (void *)4);
   if(allErrorsEncountered){
     fprintf(pythonLogFile, "Total errors encountered: %d\n", allErrorsEncountered);
   }
@@ -502,6 +516,20 @@ static int commandHandler(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, vo
     disabled = 0;
     startPython();
     XPluginEnable();
+  }else if(inCommand == startTrace){
+    if(traceStart(1 << 16)){
+      fprintf(pythonLogFile, "XPPython: Tracing python callbacks.\n");
+    }else{
+      fprintf(pythonLogFile, "XPPython: Failed to allocate trace buffer.\n");
+    }
+  }else if(inCommand == dumpTrace){
+    traceStop();
+    long cnt = traceDump(traceFileName);
+    if(cnt < 0){
+      fprintf(pythonLogFile, "XPPython: Failed to write trace to %s.\n", traceFileName);
+    }else{
+      fprintf(pythonLogFile, "XPPython: Wrote %ld trace events to %s.\n", cnt, traceFileName);
+    }
   }
   fflush(pythonLogFile);
   return 0;
@@ -569,6 +597,10 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFromWho, long inMessage, vo
   if(disabled){
     return;
   }
+  if(inMessage == XPLM_MSG_SCENERY_LOADED){
+    terrainCacheInvalidate();
+    navIndexInvalidate();
+  }
   param = PyLong_FromLong((long)inParam);
   /* printf("XPPython3 received message, which we'll try to send to all plugins: From: %d, Msg: %ld, inParam: %ld\n", */
   /*        inFromWho, inMessage, (long)inParam); */
@@ -7,6 +7,7 @@
 #include <XPLM/XPLMProcessing.h>
 #include "plugin_dl.h"
 #include "utils.h"
+#include "trace.h"
 
 static intptr_t flCntr;
 static PyObject *flDict;
@@ -38,9 +39,11 @@ static float flightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
   PyObject *inElapsedSinceLastCallObj = PyFloat_FromDouble(inElapsedSinceLastCall);
   PyObject *inElapsedTimeSinceLastFlightLoopObj = PyFloat_FromDouble(inElapsedTimeSinceLastFlightLoop);
   PyObject *counterObj = PyLong_FromLong(counter);
+  traceBegin(traceFlightLoop, PyTuple_GetItem(callbackInfo, 0), PyTuple_GetItem(callbackInfo, 1), inRefcon);
   PyObject *res = PyObject_CallFunctionObjArgs(PyTuple_GetItem(callbackInfo, 1), inElapsedSinceLastCallObj,
                                                inElapsedTimeSinceLastFlightLoopObj, counterObj,
                                                PyTuple_GetItem(callbackInfo, 3), NULL);
+  traceEnd(traceFlightLoop, inRefcon);
   float tmp;
   PyObject *err = PyErr_Occurred();
   Py_DECREF(inElapsedSinceLastCallObj);
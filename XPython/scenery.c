@@ -2,12 +2,14 @@
 #include <Python.h>
 #include <sys/time.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMScenery.h>
 #include "utils.h"
 #include "plugin_dl.h"
 #include "xppythontypes.h"
+#include "terraincache.h"
 
 static const char probeName[] = "XPLMProbeRef";
 
@@ -51,6 +53,122 @@ static PyObject *XPLMProbeTerrainXYZFun(PyObject *self, PyObject *args)
                          outInfo.velocityX, outInfo.velocityY, outInfo.velocityZ, outInfo.is_wet);
 }
 
+/* Each XPLMProbeTerrainXYZArray result row is {result, locationX, locationY, locationZ,
+   normalX, normalY, normalZ, velocityX, velocityY, velocityZ, is_wet}, all float32. */
+#define PROBE_RESULT_COLS 11
+
+static PyObject *XPLMProbeTerrainXYZArrayFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *probe, *pointsObj, *resultsObj;
+
+  if(!PyArg_ParseTuple(args, "OOO", &probe, &pointsObj, &resultsObj)){
+    return NULL;
+  }
+  XPLMProbeRef inProbe = refToPtr(probe, probeName);
+  if(!inProbe){
+    return NULL;
+  }
+  Py_buffer points, results;
+  Py_ssize_t cnt = getTypedBuffer(pointsObj, &points, 'f', false, "XPLMProbeTerrainXYZArray points");
+  if(cnt < 0){
+    return NULL;
+  }
+  Py_ssize_t resCnt = getTypedBuffer(resultsObj, &results, 'f', true, "XPLMProbeTerrainXYZArray results");
+  if(resCnt < 0){
+    PyBuffer_Release(&points);
+    return NULL;
+  }
+  if(cnt % 3){
+    PyBuffer_Release(&points);
+    PyBuffer_Release(&results);
+    PyErr_SetString(PyExc_ValueError, "XPLMProbeTerrainXYZArray points must have 3 floats per point");
+    return NULL;
+  }
+  cnt /= 3;
+  if(resCnt < cnt * PROBE_RESULT_COLS){
+    PyBuffer_Release(&points);
+    PyBuffer_Release(&results);
+    PyErr_SetString(PyExc_ValueError, "XPLMProbeTerrainXYZArray results must hold 11 floats per point");
+    return NULL;
+  }
+  const float *in = (const float *)points.buf;
+  float *out = (float *)results.buf;
+  XPLMProbeInfo_t outInfo;
+  long hits = 0;
+  for(Py_ssize_t i = 0; i < cnt; ++i, in += 3, out += PROBE_RESULT_COLS){
+    // a miss doesn't fill outInfo, so its row is zeros rather than the previous point's
+    memset(&outInfo, 0, sizeof(outInfo));
+    outInfo.structSize = sizeof(outInfo);
+    XPLMProbeResult res = XPLMProbeTerrainXYZ(inProbe, in[0], in[1], in[2], &outInfo);
+    if(res == xplm_ProbeHitTerrain){
+      ++hits;
+    }
+    out[0] = (float)res;
+    out[1] = outInfo.locationX;
+    out[2] = outInfo.locationY;
+    out[3] = outInfo.locationZ;
+    out[4] = outInfo.normalX;
+    out[5] = outInfo.normalY;
+    out[6] = outInfo.normalZ;
+    out[7] = outInfo.velocityX;
+    out[8] = outInfo.velocityY;
+    out[9] = outInfo.velocityZ;
+    out[10] = (float)outInfo.is_wet;
+  }
+  PyBuffer_Release(&points);
+  PyBuffer_Release(&results);
+  return PyLong_FromLong(hits);
+}
+
+static PyObject *XPLMTerrainCacheConfigureFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  float tileSize;
+  int capacity;
+  if(!PyArg_ParseTuple(args, "fi", &tileSize, &capacity)){
+    return NULL;
+  }
+  if(!terrainCacheConfigure(tileSize, capacity)){
+    PyErr_SetString(PyExc_ValueError, "XPLMTerrainCacheConfigure requires tileSize > 0 and capacity >= 4.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMTerrainCacheProbeFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  float inX, inY, inZ;
+  float tolerance = 0.0f;
+  if(!PyArg_ParseTuple(args, "fff|f", &inX, &inY, &inZ, &tolerance)){
+    return NULL;
+  }
+  XPLMProbeInfo_t outInfo;
+  XPLMProbeResult res = terrainCacheProbe(inX, inY, inZ, tolerance, &outInfo);
+  return PyProbeInfo_New(res, outInfo.locationX, outInfo.locationY, outInfo.locationZ,
+                         outInfo.normalX, outInfo.normalY, outInfo.normalZ,
+                         outInfo.velocityX, outInfo.velocityY, outInfo.velocityZ, outInfo.is_wet);
+}
+
+static PyObject *XPLMTerrainCacheInvalidateFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  (void) args;
+  terrainCacheInvalidate();
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPLMTerrainCacheGetStatsFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  (void) args;
+  long hits, misses;
+  int size, capacity;
+  terrainCacheStats(&hits, &misses, &size, &capacity);
+  return Py_BuildValue("(llii)", hits, misses, size, capacity);
+}
+
 static PyObject *XPLMGetMagneticVariationFun(PyObject *self, PyObject *args)
 {
   (void)self;
@@ -243,6 +361,7 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
   Py_DECREF(loaderDict);
   PyDict_Clear(libEnumDict);
   Py_DECREF(libEnumDict);
+  terrainCacheCleanup();
   Py_RETURN_NONE;
 }
 
@@ -250,6 +369,11 @@ static PyMethodDef XPLMSceneryMethods[] = {
   {"XPLMCreateProbe", XPLMCreateProbeFun, METH_VARARGS, ""},
   {"XPLMDestroyProbe", XPLMDestroyProbeFun, METH_VARARGS, ""},
   {"XPLMProbeTerrainXYZ", XPLMProbeTerrainXYZFun, METH_VARARGS, ""},
+  {"XPLMProbeTerrainXYZArray", XPLMProbeTerrainXYZArrayFun, METH_VARARGS, ""},
+  {"XPLMTerrainCacheConfigure", XPLMTerrainCacheConfigureFun, METH_VARARGS, ""},
+  {"XPLMTerrainCacheProbe", XPLMTerrainCacheProbeFun, METH_VARARGS, ""},
+  {"XPLMTerrainCacheInvalidate", XPLMTerrainCacheInvalidateFun, METH_VARARGS, ""},
+  {"XPLMTerrainCacheGetStats", XPLMTerrainCacheGetStatsFun, METH_VARARGS, ""},
   {"XPLMDegMagneticToDegTrue", XPLMDegMagneticToDegTrueFun, METH_VARARGS, ""},
   {"XPLMGetMagneticVariation", XPLMGetMagneticVariationFun, METH_VARARGS, ""},
   {"XPLMDegTrueToDegMagnetic", XPLMDegTrueToDegMagneticFun, METH_VARARGS, ""},
@@ -1,7 +1,7 @@
 from typing import Tuple, TypeVar
 
 
-def XPLMCameraControl_f(outCameraPosition: list, inIsLosingControl: bool, inRefcon: object) -> int:
+def XPLMCameraControl_f(outCameraPosition: object, inIsLosingControl: bool, inRefcon: object) -> int:
     """
     You use an XPLMCameraControl function to provide continuous control over
     the camera. You are passed outCameraPosition list in which to put the new camera
@@ -16,7 +16,13 @@ def XPLMCameraControl_f(outCameraPosition: list, inIsLosingControl: bool, inRefc
     If X-Plane is taking camera control away from you, this function will be
     called with inIsLosingControl set to 1 and outCameraPosition None.
 
-    :param outCameraPosition: list you update with new value
+    If XPLMControlCamera was called with inPositionBuffer 1, outCameraPosition is instead
+    the same array.array('f') of seven floats on every call, holding the current
+    position on entry. Set its items in place (``outCameraPosition[4] += 1``, or
+    ``outCameraPosition[:] = array('f', (x, y, z, pitch, heading, roll, zoom))``);
+    it can't be resized.
+
+    :param outCameraPosition: list (or float array) you update with new value
     :type outCameraPosition: XPLMCameraPosition_t or None
     :param inIsLosingControl: 1 if you are losing control
     :type inIsLosingControl: int
@@ -36,17 +42,64 @@ xplm_ControlCameraUntilViewChanges = 1
 xplm_ControlCameraForever = 2
 
 
-def XPLMControlCamera(inHowLong: XPLMCameraControlDuration, inControlFunc: XPLMCameraControl_f, inRefcon: object) -> None:
+def XPLMControlCamera(inHowLong: XPLMCameraControlDuration, inControlFunc: XPLMCameraControl_f, inRefcon: object,
+                      inPositionBuffer: int = 0) -> None:
     """
     This function repositions the camera on the next drawing cycle. You must
     pass a non-null control function. Specify in `XPLMCameraControlDuration` inHowLong how long you'd like
     control (indefinitely or until a key is pressed).
 
+    With inPositionBuffer 1, your callback gets a persistent float array mapped onto
+    the camera position rather than a new list every frame, which is copied to and
+    from X-Plane's position directly.
+
     :param inHowLong: int enumuration, how long you'd like control
     :type inHowLong: XPLMCameraControlDuration
     :param inControlFunc: your callback
     :type inControlFunc: XPLMCameraControl_f
     :param inRefcon: any python object
+    :param inPositionBuffer: 1 to be passed a float array rather than a list
+    :type inPositionBuffer: int
+    """
+
+
+#: Camera path events, passed to your XPLMControlCameraPath callback
+xplm_CameraPathKeyframe = 0
+xplm_CameraPathEnd = 1
+xplm_CameraPathLosingControl = 2
+
+
+def XPLMControlCameraPath(inHowLong: XPLMCameraControlDuration, inKeyframes: object, inCallback: object = None,
+                          inRefcon: object = None, inLoop: int = 0, inKeyframeEvents: int = 0) -> None:
+    """
+    Control the camera along a precomputed path. Keyframes are uploaded once, and
+    the camera position is interpolated in C every frame with a smooth (Catmull-Rom)
+    spline through them, so no python is run per frame.
+
+    inKeyframes is a float64 buffer (array.array('d'), numpy array, ...) with eight
+    values per keyframe: `time, x, y, z, pitch, heading, roll, zoom`. Times are in
+    seconds and must increase; the path starts at the first keyframe when you call
+    this. Angles take the shortest way round (heading 350 to 10 turns 20 degrees).
+
+    inCallback, if not None, is called as inCallback(event, keyframe, inRefcon) with event:
+
+     * xplm_CameraPathEnd when the last keyframe is reached (not with inLoop). Return 1
+       to keep the camera at the last keyframe, 0 to give control back to X-Plane.
+       Without a callback, control is given back.
+     * xplm_CameraPathLosingControl if X-Plane takes control away.
+     * xplm_CameraPathKeyframe, with the index of each keyframe as it is passed, only
+       if inKeyframeEvents is 1.
+
+    With inLoop 1, the path restarts from the first keyframe after the last one.
+    Calling this again replaces the path; XPLMDontControlCamera() stops it.
+
+    :param inHowLong: int enumuration, how long you'd like control
+    :type inHowLong: XPLMCameraControlDuration
+    :param inKeyframes: buffer of 8 doubles per keyframe
+    :param inCallback: your event callback, or None
+    :param inRefcon: any python object
+    :param inLoop: 1 to repeat the path
+    :param inKeyframeEvents: 1 to be called at each keyframe
     """
 
 
@@ -234,6 +234,40 @@ def XPLMUnregisterDrawCallback(inCallback, inPhase, inWantsBefore, inRefcon):
     """
     return int  # 1=callback found and unregistered, 0=otherwise
 
+###############################################################################
+
+
+def XPLMRegisterDrawListCallback(inCallback, inPhase, inWantsBefore, inRefcon, inDrawList, inInterval=0.0):
+    """ Register a drawing callback which replays a draw list.
+
+      inCallback    - callback reference, or None
+      inPhase       - integer (xplm_Phase_*)
+      inWantsBefore - integer
+      inRefcon      - integer
+      inDrawList    - draw list from XPLMCreateDrawList()
+      inInterval    - float, seconds
+
+      returns integer (0/1)
+
+      Every frame, the draw list is replayed without calling python. The
+      callback (same signature as for XPLMRegisterDrawCallback) is called only
+      when the draw list has been marked dirty, or when inInterval seconds have
+      passed since it was last called (inInterval 0.0 disables the timer).
+      Use the callback to re-record the list. Its return value is kept and
+      returned to X-Plane on the frames it is not called.
+    """
+    return int  # 0=phase does not exist; 1=registration successful
+
+###############################################################################
+
+
+def XPLMUnregisterDrawListCallback(inCallback, inPhase, inWantsBefore, inRefcon, inDrawList):
+    """Unregister a draw list callback.
+
+      returns integer (0/1)
+    """
+    return int  # 1=callback found and unregistered, 0=otherwise
+
 
 ###############################################################################
 # WINDOW API
@@ -961,7 +995,7 @@ def XPLMIsWindowInFront(inWindowID):
     return int  # 1=True
 
 
-def XPLMRegisterKeySniffer(inCallback, inBeforeWindows, inRefcon):
+def XPLMRegisterKeySniffer(inCallback, inBeforeWindows, inRefcon, inFilters=None):
     """
     This routine registers a key sniffing callback. You specify whether you want to sniff before
     the window system, or only sniff keys the window system does not consume. You should ALMOST
@@ -983,6 +1017,11 @@ def XPLMRegisterKeySniffer(inCallback, inBeforeWindows, inRefcon):
     Warning: this API declares virtual keys as a signed character; however the VKEY #define macros in XPLMDefs.h
     define the vkeys using unsigned values (that is 0x80 instead of -0x80). So you may need to cast the incoming
     vkey to an unsigned char to get correct comparisons in C.
+
+    inFilters, if not None, is a sequence of (vkey, flags) or (vkey, flags, mask)
+    tuples. The callback is called only for keystrokes matching one of them: vkey
+    equal (or -1 for any key) and (keyFlags & mask) == flags, mask defaulting to
+    flags. Other keystrokes are passed on without calling python.
     """
     return int  # 1=success
 
@@ -196,6 +196,34 @@ def XPLMLocalToWorld(inX, inY, inZ):
     return (float, float, float)  # (outLatitude, outLongitude, outAltitude)
 
 
+###############################################################################
+def XPLMWorldToLocalArray(inCoords, outCoords):
+    """Convert an array of Lat/Lon/Alt to local scene coordinates
+
+   inCoords  - float64 buffer of (latitude, longitude, altitude) triples
+   outCoords - writable float64 buffer, at least as long as inCoords,
+               which receives the (x, y, z) triples. May be inCoords.
+
+   As XPLMWorldToLocal(), for every point, in a single call. Returns
+   the number of points converted.
+    """
+    return int
+
+
+###############################################################################
+def XPLMLocalToWorldArray(inCoords, outCoords):
+    """Convert an array of local scene coordinates to Lat/Lon/Alt
+
+   inCoords  - float64 buffer of (x, y, z) triples
+   outCoords - writable float64 buffer, at least as long as inCoords,
+               which receives (latitude, longitude, altitude) triples. May be inCoords.
+
+   As XPLMLocalToWorld(), for every point, in a single call. Returns
+   the number of points converted.
+    """
+    return int
+
+
 ###############################################################################
 def XPLMDrawTranslucentDarkBox(inLeft, inTop, inRight, inBottom):
     """Draw translucent dark box
@@ -282,6 +310,175 @@ def XPLMMeasureString(inFontID, inChar):
     return float  # width of string in (fractional) pixels
 
 
+###############################################################################
+def XPLMDrawStrings(inItems, inStrings):
+    """Draw many strings with a single call
+
+      inItems    - float32 buffer (array.array('f'), numpy array, ...) holding
+                   7 values per string: x, y, r, g, b, fontID, wordWrapWidth
+      inStrings  - sequence of str, or a bytes-like object holding
+                   NUL terminated strings, one per row of inItems
+
+   Equivalent to calling XPLMDrawString() for each row, but the loop is in C.
+   A wordWrapWidth of 0 means no word wrapping.
+    """
+    return None
+
+
+###############################################################################
+def XPLMDrawNumbers(inItems):
+    """Draw many numbers with a single call
+
+      inItems    - float64 buffer (array.array('d'), numpy array, ...) holding
+                   10 values per number: x, y, r, g, b, value, digits,
+                   decimals, showSign, fontID
+
+   Equivalent to calling XPLMDrawNumber() for each row, but the loop is in C.
+    """
+    return None
+
+
+###############################################################################
+def XPLMCreateDrawList():
+    """Create an empty draw list
+
+   A draw list records XPLMDrawString, XPLMDrawNumber, XPLMDrawTranslucentDarkBox
+   and translucent rectangle commands, so they can be replayed every frame
+   without calling into python. Use XPLMRegisterDrawListCallback() to have a
+   draw callback replay it, or XPLMDrawDrawList() within your own callback.
+
+   The list is released when you no longer reference it.
+    """
+    return object  # XPLMDrawListRef
+
+
+###############################################################################
+def XPLMDrawListClear(inDrawList):
+    """Remove all commands from the draw list
+
+   Storage is kept, so re-recording a list of similar size does not allocate.
+    """
+
+
+###############################################################################
+def XPLMDrawListAddString(inDrawList, inColorRGB, inXOffset, inYOffset, inChar,
+                          inWordWrapWidth, inFontID):
+    """Record a string, parameters as XPLMDrawString()
+    """
+
+
+###############################################################################
+def XPLMDrawListAddNumber(inDrawList, inColorRGB, inXOffset, inYOffset, inValue,
+                          inDigits, inDecimals, inShowSign, inFontID):
+    """Record a number, parameters as XPLMDrawNumber()
+    """
+
+
+###############################################################################
+def XPLMDrawListAddTranslucentDarkBox(inDrawList, inLeft, inTop, inRight, inBottom):
+    """Record a translucent dark box, parameters as XPLMDrawTranslucentDarkBox()
+    """
+
+
+###############################################################################
+def XPLMDrawListAddRect(inDrawList, inColorRGBA, inLeft, inTop, inRight, inBottom):
+    """Record a filled rectangle
+
+   inColorRGBA   - list of four floats, alpha is used for blending
+    """
+
+
+###############################################################################
+def XPLMDrawListSetDirty(inDrawList, inDirty=1):
+    """Mark the draw list as needing to be recorded again
+
+   A draw list callback registered with XPLMRegisterDrawListCallback() calls
+   your python callback on the next frame it is drawn.
+    """
+
+
+###############################################################################
+def XPLMDrawDrawList(inDrawList):
+    """Draw all recorded commands of the draw list, in order
+    """
+
+
+###############################################################################
+def XPLMMeasureTextLayout(inText, inFontID, inWordWrapWidth=0):
+    """Measure multi-line text, as drawn by XPLMDrawTextPanel()
+
+   Text is broken on newlines, and on spaces to fit inWordWrapWidth (0 for
+   no wrapping). The layout is cached, keyed by text, font and wrap width.
+    """
+    return (float, int, int)  # width, height, number of lines
+
+
+###############################################################################
+def XPLMGetTextLayoutLines(inText, inFontID, inWordWrapWidth=0):
+    """Return list of (line, width) of the text's cached layout
+    """
+    return [(str, float), ]
+
+
+###############################################################################
+def XPLMDrawTextPanel(inColorRGB, inLeft, inTop, inText, inWordWrapWidth=0,
+                      inFontID=18, inLineHeight=0):  # 18 is xplmFont_Proportional
+    """Draw multi-line text, first line below inTop, using the layout cache
+
+   inLineHeight of 0 uses the font height. Returns number of lines drawn.
+    """
+    return int
+
+
+###############################################################################
+def XPLMTextLayoutCacheConfigure(inCapacity):
+    """Set number of cached text layouts (default 256), emptying the cache
+    """
+
+
+###############################################################################
+def XPLMTextLayoutCacheGetStats():
+    """Return (hits, misses, size, capacity) of the text layout cache
+    """
+    return (int, int, int, int)
+
+
+###############################################################################
+def XPLMCreateTextureStream(inTextureID, inWidth, inHeight, inFormat=0):
+    """Create a stream updating texture inTextureID from python buffers
+
+   inFormat is xplmTexFormat_RGBA8 (0) or xplmTexFormat_BGRA8. The texture is
+   allocated inWidth x inHeight on first upload. The stream is released when
+   you no longer reference it.
+    """
+    return object  # XPLMTextureStreamRef
+
+
+###############################################################################
+def XPLMTextureStreamWrite(inStream, inPixels, inX=0, inY=0, inWidth=-1, inHeight=-1, inStride=0):
+    """Copy block of 4-byte pixels from a buffer to (inX, inY) of the stream
+
+   inWidth, inHeight default to the rest of the texture. inStride is bytes
+   between rows of inPixels, 0 for packed rows. No OpenGL is used.
+    """
+
+
+###############################################################################
+def XPLMTextureStreamGetDirty(inStream):
+    """Return (x, y, width, height) written since last upload, or None
+    """
+    return (int, int, int, int)
+
+
+###############################################################################
+def XPLMTextureStreamUpload(inStream):
+    """Upload written pixels to the texture, from within a draw callback
+
+   Returns 1 if anything was uploaded, 0 if nothing was written.
+    """
+    return int
+
+
 ###############################################################################
 # X-Plane features some fixed-character fonts.  Each font may have its own
 # metrics.
@@ -299,3 +496,7 @@ xplmFont_Basic = 0
 
 # Proportional UI font.
 xplmFont_Proportional = 18
+
+# Texture stream pixel formats
+xplmTexFormat_RGBA8 = 0
+xplmTexFormat_BGRA8 = 1
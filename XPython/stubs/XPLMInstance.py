@@ -58,3 +58,61 @@ def XPLMInstanceSetPosition(instance, new_position, data):
         new_position - sequence of floats (x, y, z, pitch, heading, roll)
         data         - sequence of floats (values of datarefs)
     """
+
+
+def XPLMInstanceSetPositions(instances, positions, data=None):
+    """
+    Updates position and datarefs of many instances with a single call.
+
+        instances - sequence of handles from XPLMCreateInstance
+        positions - float32 buffer, 6 floats per instance
+                    (x, y, z, pitch, heading, roll)
+        data      - float32 buffer, values of datarefs for each instance
+                    in turn, or None if instances have no datarefs
+    """
+
+
+def XPLMCreateInstancePool(obj, datarefs, count=0):
+    """
+    Creates a pool of instances of one object, sharing one list of datarefs.
+
+        obj      - handle returned by XPLMLoadObject or XPLMLoadObjectAsync
+        datarefs - sequence of strings (dataref names)
+        count    - number of instances to create immediately
+
+    Released instances are parked out of view and reused by the next
+    XPLMInstancePoolAcquire(), rather than destroyed.
+    """
+    return int  # XPLMInstancePoolRef
+
+
+def XPLMDestroyInstancePool(pool):
+    """
+    Destroys every instance of the pool, including those acquired
+    and not yet released.
+    """
+
+
+def XPLMInstancePoolAcquire(pool):
+    """
+    Returns an instance from the pool, creating one only if none are parked.
+    Position it with XPLMInstanceSetPosition().
+    """
+    return int  # XPLMInstanceRef
+
+
+def XPLMInstancePoolRelease(pool, instance):
+    """
+    Parks the instance out of view and returns it to the pool. Do not
+    use, or call XPLMDestroyInstance() on, the instance afterwards.
+    Raises ValueError if the instance wasn't acquired from this pool, or
+    is already released.
+    """
+
+
+def XPLMInstancePoolGetInfo(pool):
+    """
+    Returns (total, available): number of instances created by the pool
+    and number currently parked.
+    """
+    return (int, int)
@@ -476,6 +476,46 @@ def XPLMMapUnproject(projection, mapX, mapY):
     return float, float  # latitude, longitude
 
 
+def XPLMMapProjectArray(projection, inLatLon, outXY):
+    """
+    Projects many points: inLatLon is a float64 buffer (array.array('d'),
+    numpy array, ...) of latitude, longitude pairs, outXY a writable float32
+    buffer, at least as long, receiving map x, y pairs.
+
+    Returns number of points. Only valid from within a map layer callback.
+    """
+    return int
+
+
+def XPLMMapUnprojectArray(projection, inXY, outLatLon):
+    """
+    Inverse of XPLMMapProjectArray(): float32 x, y pairs in, float64
+    latitude, longitude pairs out. Returns number of points.
+    """
+    return int
+
+
+def XPLMDrawMapIconsFromSheet(layer, inPngPath, inItems, projection=None):
+    """
+    Draws many icons from one sheet, as XPLMDrawMapIconFromSheet() per row of
+    inItems, a float64 buffer with 9 values per icon:
+      x, y, s, t, ds, dt, orientation, rotationDegrees, mapWidth
+
+    If projection is given, x, y are latitude, longitude and are projected.
+    """
+
+
+def XPLMDrawMapLabels(layer, inItems, inLabels, projection=None):
+    """
+    Draws many labels, as XPLMDrawMapLabel() per row of inItems, a float64
+    buffer with 4 values per label:
+      x, y, orientation, rotationDegrees
+
+    inLabels is a sequence of str, or bytes-like object holding NUL terminated
+    strings, one per row. If projection is given, x, y are latitude, longitude.
+    """
+
+
 def XPLMMapScaleMeter(projection, mapX, mapY):
     """
     Returns the number of map units that correspond to a distance of one meter
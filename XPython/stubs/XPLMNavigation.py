@@ -194,6 +194,60 @@ def XPLMGetNavAidInfo(inRef):
     return NavAidInfo
 
 
+def XPLMNavIndexRebuild():
+    """
+    Rebuilds the navaid spatial index from the navaid database, returning
+    the number of navaids indexed. The index is built on first query, and
+    rebuilt after scenery is reloaded, so calling this is rarely needed.
+    """
+    return int
+
+
+def XPLMNavIndexNearest(lat, lon, count=1, types=0, maxDistance=0.0):
+    """
+    Returns the (up to) count navaids nearest to lat, lon as
+    (array('i') of XPLMNavRef, array('d') of distances in nautical miles),
+    nearest first.
+
+    types       : OR-ed XPLMNavType values, 0 for any type
+    maxDistance : nautical miles, 0.0 for no limit
+    """
+    return (array, array)
+
+
+def XPLMNavIndexWithinRadius(lat, lon, radius, types=0):
+    """
+    Returns navaids within radius (nautical miles) of lat, lon, as
+    (array('i') of XPLMNavRef, array('d') of distances), nearest first.
+    """
+    return (array, array)
+
+
+def XPLMNavIndexWithinBox(south, west, north, east, types=0):
+    """
+    Returns array('i') of XPLMNavRef for navaids within the lat/lon box.
+    west > east means the box crosses the 180th meridian.
+    """
+    return array
+
+
+def XPLMNavExport(cachePath=None, key=None):
+    """
+    Exports the entire navaid database in a single pass, returning a dict of
+    memoryview columns, one entry per navaid:
+      ref, type, frequency         - 'i'
+      latitude, longitude, height,
+      heading                      - 'f'
+      id, name                     - 'I', offsets into strings of NUL terminated bytes
+      strings                      - 'B'
+
+    With cachePath, the export is saved to that file, and later calls (even
+    in later sessions) map the file rather than reading the database, as long
+    as the database, sim version and key (e.g., AIRAC cycle) are unchanged.
+    """
+    return dict
+
+
 def XPLMCountFMSEntries():
     """
     This routine returns the number of entries in the FMS.
@@ -278,6 +332,26 @@ def XPLMClearFMSEntry(inIndex):
     """
 
 
+def XPLMGetFMSEntries(outEntries):
+    """
+    Reads every FMS entry into outEntries, a writable float64 buffer
+    holding 5 values per entry: type, navRef, altitude, lat, lon.
+    Returns the number of entries.
+    """
+    return int
+
+
+def XPLMSetFMSEntries(inEntries):
+    """
+    Programs the entire flight plan from inEntries, a float64 buffer
+    holding 5 values per entry (as XPLMGetFMSEntries). A navRef of
+    XPLM_NAV_NOT_FOUND is a lat/lon entry. Only entries which differ from
+    the current plan are set, and any extra entries are cleared. Returns
+    the number of entries changed.
+    """
+    return int
+
+
 def XPLMGetGPSDestinationType():
     """
     This routine returns the type of the currently selected GPS destination,
@@ -134,6 +134,56 @@ def XPLMProbeTerrainXYZ(inProbe, inX, inY, inZ):
     return PyProbeInfo
 
 
+def XPLMProbeTerrainXYZArray(inProbe, inPoints, outResults):
+    """
+    Probes the terrain at many points with a single call.
+
+    inProbe    : probe handle obtained from XPLMCreateProbe
+    inPoints   : float32 buffer of x, y, z for each point
+    outResults : writable float32 buffer, receiving 11 floats per point:
+      result, locationX, locationY, locationZ, normalX, normalY, normalZ,
+      velocityX, velocityY, velocityZ, is_wet
+
+    Returns the number of points which hit terrain.
+    """
+    return int
+
+
+def XPLMTerrainCacheConfigure(tileSize, capacity):
+    """
+    Sets the grid spacing (meters) and maximum number of tiles of the
+    shared terrain cache, emptying it. Defaults are 10.0 meters and 4096 tiles.
+    """
+
+
+def XPLMTerrainCacheProbe(inX, inY, inZ, tolerance=0.0):
+    """
+    Probes the terrain through the shared terrain cache.
+
+    The cache holds one probe result per grid node. If the nearest node is within
+    tolerance (meters, horizontal) of the query, its result is returned.
+    Otherwise, if tolerance > 0, the result is interpolated from the four surrounding
+    nodes. With tolerance 0, only queries exactly on a grid node use the cache.
+
+    Returns PyProbeInfo, as XPLMProbeTerrainXYZ.
+    """
+    return PyProbeInfo
+
+
+def XPLMTerrainCacheInvalidate():
+    """
+    Empties the shared terrain cache. This is done automatically
+    when new scenery is loaded.
+    """
+
+
+def XPLMTerrainCacheGetStats():
+    """
+    Returns (hits, misses, size, capacity) of the shared terrain cache.
+    """
+    return (int, int, int, int)
+
+
 def XPLMGetMagneticVariation(latitude, longitude):
     """
     Returns X-Plane's simulated magnetic variation (declination) at the
@@ -320,7 +320,7 @@ def XPLMCreateCommand(inName, inDescription):
     return int  # XPLMCommandRef
 
 
-def XPLMRegisterCommandHandler(inComand, inHandler, inBefore, inRefcon):
+def XPLMRegisterCommandHandler(inComand, inHandler, inBefore, inRefcon, inPhases=None, inContinueInterval=0.0):
     """
     XPLMRegisterCommandHandler registers a callback to be called when a command
     is executed. You provide a callback with a reference pointer.
@@ -330,6 +330,12 @@ def XPLMRegisterCommandHandler(inComand, inHandler, inBefore, inRefcon):
     disable X-Plane's processing of the command. If inBefore is false, your
     callback will run after X-Plane. (You can register a single callback both
     before and after a command.)
+
+    inPhases, if not None, is a list of the phases (xplm_CommandBegin, xplm_CommandContinue,
+    xplm_CommandEnd) your callback wants. With inContinueInterval > 0, xplm_CommandContinue
+    is passed at most once every inContinueInterval seconds while the command is held.
+    Other phases don't call python: they are answered with your callback's latest return
+    value, so a handler returning 0 keeps blocking the command.
     """
 
 
@@ -9,3 +9,25 @@ def XPPythonGetDicts():
 
 def XPPythonGetCapsules():
     return {}
+
+
+def XPPythonTraceStart(capacity=65536):
+    """Start recording begin/end events for every python callback dispatch.
+
+    Events (plugin, callback kind, refcon, timestamp) are stored in a preallocated
+    ring buffer of capacity events; once full, oldest events are overwritten.
+    """
+    return None
+
+
+def XPPythonTraceStop():
+    """Stop recording callback events. Recorded events are kept until the next start."""
+    return None
+
+
+def XPPythonTraceDump(filename):
+    """Write recorded events to filename as Chrome trace-event JSON.
+
+    Load the file in chrome://tracing or ui.perfetto.dev. Returns number of events written.
+    """
+    return int
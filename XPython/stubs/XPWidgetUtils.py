@@ -72,6 +72,25 @@ def XPUCreateWidgets(inWidgetDefs,
     pass
 
 
+def XPUCreateWidgetTree(inDefs, inDescriptors, inParamParent=None,
+                        inProperties=None, inUserProperties=None, inCallbacks=None):
+    """
+    Creates a widget tree in one call, as XPUCreateWidgets, also setting
+    properties and attaching widget callbacks. Returns a tuple of the
+    created widget IDs.
+
+    inDefs: buffer of int32 (e.g., array('i')), 8 per widget:
+        left, top, right, bottom, visible, isRoot, containerIndex, widgetClass
+        (containerIndex is NO_PARENT, PARAM_PARENT or the index of an earlier widget)
+    inDescriptors: sequence of str, or bytes of NUL terminated strings, one per widget
+    inParamParent: ID of the parent used for PARAM_PARENT, or None
+    inProperties: buffer of int32, 3 per property: widgetIndex, property, value
+    inUserProperties: sequence of (widgetIndex, property, value) tuples
+    inCallbacks: sequence of (widgetIndex, callback) or (widgetIndex, callback, messages) tuples
+    """
+    return tuple  # XPWidgetIDs
+
+
 def XPUMoveWidgetBy(inWidget, inDeltaX, inDeltaY):
     """
     Simply moves a widget by an amount, +x = right, +y=up, without resizing the
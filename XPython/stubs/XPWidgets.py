@@ -115,13 +115,17 @@ def XPCreateCustomWidget(inLeft, inTop, inRight, inBottom,
                          inDescriptor,
                          inIsRoot,
                          inContainer,
-                         inCallback):
+                         inCallback,
+                         inMessages=None):
     """
     This function is the same as XPCreateWidget except that instead of passing
     a class ID, you pass your widget callback function pointer defining the
     widget. Use this function to define a custom widget. All parameters are the
     same as XPCreateWidget, except that the widget class has been replaced with
     the widget function.
+
+    inMessages, if not None, is a list of the widget messages the callback
+    wants. Other messages are not passed to python, and are treated as not handled.
     """
     return int  # XPWidgetID
 
@@ -392,7 +396,7 @@ def XPGetWidgetWithFocus():
     return int  # XPWidgetID or 0 if X-Plane has focus
 
 
-def XPAddWidgetCallback(inWidget, inNewCallback):
+def XPAddWidgetCallback(inWidget, inNewCallback, inMessages=None):
     """
     This function adds a new widget callback to a widget. This widget callback
     supercedes any existing ones and will receive messages first; if it does
@@ -406,6 +410,9 @@ def XPAddWidgetCallback(inWidget, inNewCallback):
     This provides a way to 'subclass' an existing widget. By providing a second
     hook that only handles certain widget messages, you can customize or extend
     widget behavior.
+
+    inMessages, if not None, is a list of the widget messages the callback
+    wants. Other messages are not passed to python, and are treated as not handled.
     """
 
 
@@ -1,10 +1,14 @@
 import XPLMCamera
 controlCamera = XPLMCamera.XPLMControlCamera
+controlCameraPath = XPLMCamera.XPLMControlCameraPath
 dontControlCamera = XPLMCamera.XPLMDontControlCamera
 isCameraBeingControlled = XPLMCamera.XPLMIsCameraBeingControlled
 readCameraPosition = XPLMCamera.XPLMReadCameraPosition
 ControlCameraUntilViewChanges = XPLMCamera.xplm_ControlCameraUntilViewChanges
 ControlCameraForever = XPLMCamera.xplm_ControlCameraForever
+CameraPathKeyframe = XPLMCamera.xplm_CameraPathKeyframe
+CameraPathEnd = XPLMCamera.xplm_CameraPathEnd
+CameraPathLosingControl = XPLMCamera.xplm_CameraPathLosingControl
 import XPLMDataAccess
 findDataRef = XPLMDataAccess.XPLMFindDataRef
 canWriteDataRef = XPLMDataAccess.XPLMCanWriteDataRef
@@ -174,6 +178,8 @@ VK_NUMPAD_EQ = XPLMDefs.XPLM_VK_NUMPAD_EQ
 import XPLMDisplay
 registerDrawCallback = XPLMDisplay.XPLMRegisterDrawCallback
 unregisterDrawCallback = XPLMDisplay.XPLMUnregisterDrawCallback
+registerDrawListCallback = XPLMDisplay.XPLMRegisterDrawListCallback
+unregisterDrawListCallback = XPLMDisplay.XPLMUnregisterDrawListCallback
 createWindowEx = XPLMDisplay.XPLMCreateWindowEx
 destroyWindow = XPLMDisplay.XPLMDestroyWindow
 getScreenSize = XPLMDisplay.XPLMGetScreenSize
@@ -242,17 +248,46 @@ bindTexture2d = XPLMGraphics.XPLMBindTexture2d
 generateTextureNumbers = XPLMGraphics.XPLMGenerateTextureNumbers
 worldToLocal = XPLMGraphics.XPLMWorldToLocal
 localToWorld = XPLMGraphics.XPLMLocalToWorld
+worldToLocalArray = XPLMGraphics.XPLMWorldToLocalArray
+localToWorldArray = XPLMGraphics.XPLMLocalToWorldArray
 drawTranslucentDarkBox = XPLMGraphics.XPLMDrawTranslucentDarkBox
 drawString = XPLMGraphics.XPLMDrawString
 drawNumber = XPLMGraphics.XPLMDrawNumber
 getFontDimensions = XPLMGraphics.XPLMGetFontDimensions
 measureString = XPLMGraphics.XPLMMeasureString
+drawStrings = XPLMGraphics.XPLMDrawStrings
+drawNumbers = XPLMGraphics.XPLMDrawNumbers
+createDrawList = XPLMGraphics.XPLMCreateDrawList
+drawListClear = XPLMGraphics.XPLMDrawListClear
+drawListAddString = XPLMGraphics.XPLMDrawListAddString
+drawListAddNumber = XPLMGraphics.XPLMDrawListAddNumber
+drawListAddTranslucentDarkBox = XPLMGraphics.XPLMDrawListAddTranslucentDarkBox
+drawListAddRect = XPLMGraphics.XPLMDrawListAddRect
+drawListSetDirty = XPLMGraphics.XPLMDrawListSetDirty
+drawDrawList = XPLMGraphics.XPLMDrawDrawList
+measureTextLayout = XPLMGraphics.XPLMMeasureTextLayout
+getTextLayoutLines = XPLMGraphics.XPLMGetTextLayoutLines
+drawTextPanel = XPLMGraphics.XPLMDrawTextPanel
+textLayoutCacheConfigure = XPLMGraphics.XPLMTextLayoutCacheConfigure
+textLayoutCacheGetStats = XPLMGraphics.XPLMTextLayoutCacheGetStats
+createTextureStream = XPLMGraphics.XPLMCreateTextureStream
+textureStreamWrite = XPLMGraphics.XPLMTextureStreamWrite
+textureStreamGetDirty = XPLMGraphics.XPLMTextureStreamGetDirty
+textureStreamUpload = XPLMGraphics.XPLMTextureStreamUpload
 Font_Basic = XPLMGraphics.xplmFont_Basic
 Font_Proportional = XPLMGraphics.xplmFont_Proportional
+TexFormat_RGBA8 = XPLMGraphics.xplmTexFormat_RGBA8
+TexFormat_BGRA8 = XPLMGraphics.xplmTexFormat_BGRA8
 import XPLMInstance
 createInstance = XPLMInstance.XPLMCreateInstance
 destroyInstance = XPLMInstance.XPLMDestroyInstance
 instanceSetPosition = XPLMInstance.XPLMInstanceSetPosition
+instanceSetPositions = XPLMInstance.XPLMInstanceSetPositions
+createInstancePool = XPLMInstance.XPLMCreateInstancePool
+destroyInstancePool = XPLMInstance.XPLMDestroyInstancePool
+instancePoolAcquire = XPLMInstance.XPLMInstancePoolAcquire
+instancePoolRelease = XPLMInstance.XPLMInstancePoolRelease
+instancePoolGetInfo = XPLMInstance.XPLMInstancePoolGetInfo
 import XPLMMap
 createMapLayer = XPLMMap.XPLMCreateMapLayer
 destroyMapLayer = XPLMMap.XPLMDestroyMapLayer
@@ -262,6 +297,10 @@ drawMapIconFromSheet = XPLMMap.XPLMDrawMapIconFromSheet
 drawMapLabel = XPLMMap.XPLMDrawMapLabel
 mapProject = XPLMMap.XPLMMapProject
 mapUnproject = XPLMMap.XPLMMapUnproject
+mapProjectArray = XPLMMap.XPLMMapProjectArray
+mapUnprojectArray = XPLMMap.XPLMMapUnprojectArray
+drawMapIconsFromSheet = XPLMMap.XPLMDrawMapIconsFromSheet
+drawMapLabels = XPLMMap.XPLMDrawMapLabels
 mapScaleMeter = XPLMMap.XPLMMapScaleMeter
 mapGetNorthHeading = XPLMMap.XPLMMapGetNorthHeading
 MapStyle_VFR_Sectional = XPLMMap.xplm_MapStyle_VFR_Sectional
@@ -297,6 +336,11 @@ findFirstNavAidOfType = XPLMNavigation.XPLMFindFirstNavAidOfType
 findLastNavAidOfType = XPLMNavigation.XPLMFindLastNavAidOfType
 findNavAid = XPLMNavigation.XPLMFindNavAid
 getNavAidInfo = XPLMNavigation.XPLMGetNavAidInfo
+navIndexRebuild = XPLMNavigation.XPLMNavIndexRebuild
+navIndexNearest = XPLMNavigation.XPLMNavIndexNearest
+navIndexWithinRadius = XPLMNavigation.XPLMNavIndexWithinRadius
+navIndexWithinBox = XPLMNavigation.XPLMNavIndexWithinBox
+navExport = XPLMNavigation.XPLMNavExport
 countFMSEntries = XPLMNavigation.XPLMCountFMSEntries
 getDisplayedFMSEntry = XPLMNavigation.XPLMGetDisplayedFMSEntry
 getDestinationFMSEntry = XPLMNavigation.XPLMGetDestinationFMSEntry
@@ -306,6 +350,8 @@ getFMSEntryInfo = XPLMNavigation.XPLMGetFMSEntryInfo
 setFMSEntryInfo = XPLMNavigation.XPLMSetFMSEntryInfo
 setFMSEntryLatLon = XPLMNavigation.XPLMSetFMSEntryLatLon
 clearFMSEntry = XPLMNavigation.XPLMClearFMSEntry
+getFMSEntries = XPLMNavigation.XPLMGetFMSEntries
+setFMSEntries = XPLMNavigation.XPLMSetFMSEntries
 getGPSDestinationType = XPLMNavigation.XPLMGetGPSDestinationType
 getGPSDestination = XPLMNavigation.XPLMGetGPSDestination
 Nav_Unknown = XPLMNavigation.xplm_Nav_Unknown
@@ -385,6 +431,11 @@ import XPLMScenery
 createProbe = XPLMScenery.XPLMCreateProbe
 destroyProbe = XPLMScenery.XPLMDestroyProbe
 probeTerrainXYZ = XPLMScenery.XPLMProbeTerrainXYZ
+probeTerrainXYZArray = XPLMScenery.XPLMProbeTerrainXYZArray
+terrainCacheConfigure = XPLMScenery.XPLMTerrainCacheConfigure
+terrainCacheProbe = XPLMScenery.XPLMTerrainCacheProbe
+terrainCacheInvalidate = XPLMScenery.XPLMTerrainCacheInvalidate
+terrainCacheGetStats = XPLMScenery.XPLMTerrainCacheGetStats
 getMagneticVariation = XPLMScenery.XPLMGetMagneticVariation
 degTrueToDegMagnetic = XPLMScenery.XPLMDegTrueToDegMagnetic
 degMagneticToDegTrue = XPLMScenery.XPLMDegMagneticToDegTrue
@@ -440,6 +491,9 @@ CommandEnd = XPLMUtilities.xplm_CommandEnd
 import XPPython
 pythonGetDicts = XPPython.XPPythonGetDicts
 pythonGetCapsules = XPPython.XPPythonGetCapsules
+pythonTraceStart = XPPython.XPPythonTraceStart
+pythonTraceStop = XPPython.XPPythonTraceStop
+pythonTraceDump = XPPython.XPPythonTraceDump
 import XPStandardWidgets
 WidgetClass_MainWindow = XPStandardWidgets.xpWidgetClass_MainWindow
 WidgetClass_SubWindow = XPStandardWidgets.xpWidgetClass_SubWindow
@@ -639,6 +693,7 @@ addWidgetCallback = XPWidgets.XPAddWidgetCallback
 getWidgetClassFunc = XPWidgets.XPGetWidgetClassFunc
 import XPWidgetUtils
 createWidgets = XPWidgetUtils.XPUCreateWidgets
+createWidgetTree = XPWidgetUtils.XPUCreateWidgetTree
 moveWidgetBy = XPWidgetUtils.XPUMoveWidgetBy
 fixedLayout = XPWidgetUtils.XPUFixedLayout
 selectIfNeeded = XPWidgetUtils.XPUSelectIfNeeded
@@ -0,0 +1,266 @@
+#define _GNU_SOURCE 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMScenery.h>
+#include "terraincache.h"
+
+/*
+ * Terrain elevation cache.
+ *
+ * Query positions are quantized to a grid of tileSize meters (in local x/z); each tile
+ * holds the result of a single probe at its grid node. Tiles live in a fixed array,
+ * found through a hash table and kept in least-recently-used order, so once the cache
+ * is full the oldest tile is reused and lookups never allocate.
+ *
+ * Local coordinates move when new scenery is loaded, so the plugin invalidates the
+ * cache on XPLM_MSG_SCENERY_LOADED.
+ */
+
+#define TERRAIN_CACHE_DEFAULT_TILE 10.0f
+#define TERRAIN_CACHE_DEFAULT_CAPACITY 4096
+
+typedef struct {
+  int ix, iz;           // grid node
+  int prev, next;       // LRU list, most recently used at terrainHead
+  int hnext;            // hash chain
+  XPLMProbeResult result;
+  XPLMProbeInfo_t info;
+} terrainTile;
+
+static float terrainTileSize = TERRAIN_CACHE_DEFAULT_TILE;
+static terrainTile *terrainTiles = NULL;
+static int terrainCapacity;
+static int terrainCount;
+static int *terrainBuckets = NULL;
+static unsigned int terrainBucketMask;
+static int terrainHead = -1, terrainTail = -1;
+static long terrainHits, terrainMisses;
+static XPLMProbeRef terrainProbe = NULL;
+
+static unsigned int terrainHash(int ix, int iz)
+{
+  return ((unsigned int)ix * 73856093u ^ (unsigned int)iz * 19349663u) & terrainBucketMask;
+}
+
+void terrainCacheInvalidate(void)
+{
+  terrainCount = 0;
+  terrainHead = terrainTail = -1;
+  if(terrainBuckets){
+    memset(terrainBuckets, 0xff, (terrainBucketMask + 1) * sizeof(int));
+  }
+}
+
+bool terrainCacheConfigure(float tileSize, int capacity)
+{
+  if(tileSize <= 0.0f || capacity < 4){
+    return false;
+  }
+  unsigned int buckets = 1;
+  while(buckets < (unsigned int)capacity * 2){
+    buckets <<= 1;
+  }
+  terrainTile *tiles = (terrainTile *)malloc(capacity * sizeof(terrainTile));
+  int *bucketArray = (int *)malloc(buckets * sizeof(int));
+  if(!tiles || !bucketArray){
+    free(tiles);
+    free(bucketArray);
+    return false;
+  }
+  free(terrainTiles);
+  free(terrainBuckets);
+  terrainTiles = tiles;
+  terrainBuckets = bucketArray;
+  terrainBucketMask = buckets - 1;
+  terrainCapacity = capacity;
+  terrainTileSize = tileSize;
+  terrainHits = terrainMisses = 0;
+  terrainCacheInvalidate();
+  return true;
+}
+
+static void terrainUnlink(int idx)
+{
+  terrainTile *tile = &terrainTiles[idx];
+  if(tile->prev >= 0){
+    terrainTiles[tile->prev].next = tile->next;
+  }else{
+    terrainHead = tile->next;
+  }
+  if(tile->next >= 0){
+    terrainTiles[tile->next].prev = tile->prev;
+  }else{
+    terrainTail = tile->prev;
+  }
+}
+
+static void terrainPushFront(int idx)
+{
+  terrainTile *tile = &terrainTiles[idx];
+  tile->prev = -1;
+  tile->next = terrainHead;
+  if(terrainHead >= 0){
+    terrainTiles[terrainHead].prev = idx;
+  }
+  terrainHead = idx;
+  if(terrainTail < 0){
+    terrainTail = idx;
+  }
+}
+
+static void terrainUnhash(int idx)
+{
+  int *link = &terrainBuckets[terrainHash(terrainTiles[idx].ix, terrainTiles[idx].iz)];
+  while(*link >= 0){
+    if(*link == idx){
+      *link = terrainTiles[idx].hnext;
+      return;
+    }
+    link = &terrainTiles[*link].hnext;
+  }
+}
+
+static XPLMProbeResult terrainDirectProbe(float x, float y, float z, XPLMProbeInfo_t *outInfo)
+{
+  if(!terrainProbe){
+    terrainProbe = XPLMCreateProbe(xplm_ProbeY);
+  }
+  outInfo->structSize = sizeof(XPLMProbeInfo_t);
+  return XPLMProbeTerrainXYZ(terrainProbe, x, y, z, outInfo);
+}
+
+// Returns tile for grid node (ix, iz), probing (at height y) if it isn't cached.
+static terrainTile *terrainFetch(int ix, int iz, float y, bool *probed)
+{
+  static terrainTile scratch;
+  unsigned int h = terrainHash(ix, iz);
+  for(int idx = terrainBuckets[h]; idx >= 0; idx = terrainTiles[idx].hnext){
+    if(terrainTiles[idx].ix == ix && terrainTiles[idx].iz == iz){
+      if(idx != terrainHead){
+        terrainUnlink(idx);
+        terrainPushFront(idx);
+      }
+      return &terrainTiles[idx];
+    }
+  }
+  *probed = true;
+  // a miss leaves info unset, and the tile is cached: store zeros
+  XPLMProbeInfo_t info = {0};
+  XPLMProbeResult result = terrainDirectProbe(ix * terrainTileSize, y, iz * terrainTileSize, &info);
+  terrainTile *tile = &scratch;
+  if(result != xplm_ProbeError){
+    // errors aren't cached, next query will probe again
+    int idx;
+    if(terrainCount < terrainCapacity){
+      idx = terrainCount++;
+    }else{
+      idx = terrainTail;
+      terrainUnlink(idx);
+      terrainUnhash(idx);
+    }
+    tile = &terrainTiles[idx];
+    tile->hnext = terrainBuckets[h];
+    terrainBuckets[h] = idx;
+    terrainPushFront(idx);
+  }
+  tile->ix = ix;
+  tile->iz = iz;
+  tile->result = result;
+  tile->info = info;
+  return tile;
+}
+
+XPLMProbeResult terrainCacheProbe(float x, float y, float z, float tolerance, XPLMProbeInfo_t *outInfo)
+{
+  if(!terrainTiles && !terrainCacheConfigure(terrainTileSize, TERRAIN_CACHE_DEFAULT_CAPACITY)){
+    return xplm_ProbeError;
+  }
+  XPLMProbeResult result;
+  bool probed = false;
+  float fx = x / terrainTileSize, fz = z / terrainTileSize;
+  int nx = (int)floorf(fx + 0.5f), nz = (int)floorf(fz + 0.5f);
+  float dx = (fx - nx) * terrainTileSize, dz = (fz - nz) * terrainTileSize;
+
+  if(dx * dx + dz * dz <= tolerance * tolerance){
+    // nearest grid node is close enough
+    terrainTile *tile = terrainFetch(nx, nz, y, &probed);
+    result = tile->result;
+    *outInfo = tile->info;
+  }else if(tolerance > 0.0f){
+    // bilinear interpolation between the four surrounding nodes. Capacity is at least 4,
+    //  so fetching one corner never evicts another.
+    int ix = (int)floorf(fx), iz = (int)floorf(fz);
+    float tx = fx - ix, tz = fz - iz;
+    terrainTile *c[4] = {
+      terrainFetch(ix, iz, y, &probed), terrainFetch(ix + 1, iz, y, &probed),
+      terrainFetch(ix, iz + 1, y, &probed), terrainFetch(ix + 1, iz + 1, y, &probed)
+    };
+    float w[4] = {(1 - tx) * (1 - tz), tx * (1 - tz), (1 - tx) * tz, tx * tz};
+    bool allHit = true;
+    for(int i = 0; i < 4; ++i){
+      allHit = allHit && c[i]->result == xplm_ProbeHitTerrain;
+    }
+    if(allHit){
+      XPLMProbeInfo_t *nearest = &c[(tx >= 0.5f ? 1 : 0) + (tz >= 0.5f ? 2 : 0)]->info;
+      *outInfo = *nearest;
+      outInfo->locationX = x;
+      outInfo->locationZ = z;
+      outInfo->locationY = outInfo->normalX = outInfo->normalY = outInfo->normalZ = 0.0f;
+      for(int i = 0; i < 4; ++i){
+        outInfo->locationY += w[i] * c[i]->info.locationY;
+        outInfo->normalX += w[i] * c[i]->info.normalX;
+        outInfo->normalY += w[i] * c[i]->info.normalY;
+        outInfo->normalZ += w[i] * c[i]->info.normalZ;
+      }
+      float len = sqrtf(outInfo->normalX * outInfo->normalX + outInfo->normalY * outInfo->normalY
+                        + outInfo->normalZ * outInfo->normalZ);
+      if(len > 0.0f){
+        outInfo->normalX /= len;
+        outInfo->normalY /= len;
+        outInfo->normalZ /= len;
+      }
+      result = xplm_ProbeHitTerrain;
+    }else{
+      // edge of terrain (or water / error): don't interpolate across it
+      probed = true;
+      result = terrainDirectProbe(x, y, z, outInfo);
+    }
+  }else{
+    probed = true;
+    result = terrainDirectProbe(x, y, z, outInfo);
+  }
+  if(probed){
+    ++terrainMisses;
+  }else{
+    ++terrainHits;
+  }
+  return result;
+}
+
+void terrainCacheStats(long *hits, long *misses, int *size, int *capacity)
+{
+  *hits = terrainHits;
+  *misses = terrainMisses;
+  *size = terrainCount;
+  *capacity = terrainTiles ? terrainCapacity : TERRAIN_CACHE_DEFAULT_CAPACITY;
+}
+
+void terrainCacheCleanup(void)
+{
+  if(terrainProbe){
+    XPLMDestroyProbe(terrainProbe);
+    terrainProbe = NULL;
+  }
+  free(terrainTiles);
+  free(terrainBuckets);
+  terrainTiles = NULL;
+  terrainBuckets = NULL;
+  terrainCount = 0;
+  terrainHead = terrainTail = -1;
+  terrainHits = terrainMisses = 0;
+  terrainTileSize = TERRAIN_CACHE_DEFAULT_TILE;
+}
@@ -0,0 +1,17 @@
+#ifndef TERRAINCACHE__H
+#define TERRAINCACHE__H
+
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMScenery.h>
+
+/* Terrain elevation cache shared by all python plugins: probe results are kept
+   per tile of a horizontal grid, in a bounded LRU. */
+
+bool terrainCacheConfigure(float tileSize, int capacity);
+XPLMProbeResult terrainCacheProbe(float x, float y, float z, float tolerance, XPLMProbeInfo_t *outInfo);
+void terrainCacheInvalidate(void);
+void terrainCacheStats(long *hits, long *misses, int *size, int *capacity);
+void terrainCacheCleanup(void);
+
+#endif
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "texstage.h"
+
+/*
+ * Staging for streamed textures.
+ *
+ * Writes from python land here, and only grow the dirty rectangle; the upload (in a
+ * draw callback) then sends that one rectangle, however many writes made it. Keeping
+ * a single bounding rectangle, rather than a list, means a few scattered updates may
+ * upload unchanged pixels between them, but each frame costs one texture transfer.
+ */
+
+bool texStageInit(texStage *stage, int width, int height)
+{
+  memset(stage, 0, sizeof(texStage));
+  if(width <= 0 || height <= 0){
+    return false;
+  }
+  stage->pixels = (unsigned char *)calloc((size_t)width * height, TEX_STAGE_BPP);
+  if(!stage->pixels){
+    return false;
+  }
+  stage->width = width;
+  stage->height = height;
+  // the texture starts undefined, so the first upload sends all of it
+  texStageMarkDirty(stage, 0, 0, width, height);
+  return true;
+}
+
+void texStageFree(texStage *stage)
+{
+  free(stage->pixels);
+  stage->pixels = NULL;
+  stage->width = stage->height = 0;
+  stage->dirty.width = 0;
+}
+
+bool texStageWrite(texStage *stage, const unsigned char *src, size_t srcStride, int x, int y, int width, int height)
+{
+  if(x < 0 || y < 0 || width < 0 || height < 0 || x > stage->width - width || y > stage->height - height){
+    return false;
+  }
+  if(width == 0 || height == 0){
+    return true;
+  }
+  size_t rowBytes = (size_t)width * TEX_STAGE_BPP;
+  size_t stride = (size_t)stage->width * TEX_STAGE_BPP;
+  unsigned char *dst = stage->pixels + (size_t)y * stride + (size_t)x * TEX_STAGE_BPP;
+  if(rowBytes == stride && srcStride == stride){
+    memcpy(dst, src, rowBytes * height);
+  }else{
+    for(int row = 0; row < height; ++row){
+      memcpy(dst, src, rowBytes);
+      dst += stride;
+      src += srcStride;
+    }
+  }
+  texStageMarkDirty(stage, x, y, width, height);
+  return true;
+}
+
+void texStageMarkDirty(texStage *stage, int x, int y, int width, int height)
+{
+  if(width <= 0 || height <= 0){
+    return;
+  }
+  texRect *dirty = &stage->dirty;
+  if(dirty->width == 0){
+    dirty->x = x;
+    dirty->y = y;
+    dirty->width = width;
+    dirty->height = height;
+    return;
+  }
+  int right = dirty->x + dirty->width;
+  int top = dirty->y + dirty->height;
+  if(x + width > right){
+    right = x + width;
+  }
+  if(y + height > top){
+    top = y + height;
+  }
+  if(x < dirty->x){
+    dirty->x = x;
+  }
+  if(y < dirty->y){
+    dirty->y = y;
+  }
+  dirty->width = right - dirty->x;
+  dirty->height = top - dirty->y;
+}
+
+bool texStageTakeDirty(texStage *stage, texRect *rect)
+{
+  if(stage->dirty.width == 0){
+    return false;
+  }
+  *rect = stage->dirty;
+  stage->dirty.width = 0;
+  return true;
+}
+
+void texStageCopyRect(const texStage *stage, const texRect *rect, unsigned char *dst)
+{
+  size_t rowBytes = (size_t)rect->width * TEX_STAGE_BPP;
+  size_t stride = (size_t)stage->width * TEX_STAGE_BPP;
+  const unsigned char *src = stage->pixels + (size_t)rect->y * stride + (size_t)rect->x * TEX_STAGE_BPP;
+  if(rowBytes == stride){
+    memcpy(dst, src, rowBytes * rect->height);
+    return;
+  }
+  for(int row = 0; row < rect->height; ++row){
+    memcpy(dst, src, rowBytes);
+    dst += rowBytes;
+    src += stride;
+  }
+}
@@ -0,0 +1,33 @@
+#ifndef TEXSTAGE__H
+#define TEXSTAGE__H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* CPU-side copy of a streamed texture, with the bounding rectangle of pixels written
+   since the last upload. No OpenGL here, see texstream.c for the upload. */
+
+#define TEX_STAGE_BPP 4
+
+typedef struct {
+  int x, y, width, height;
+} texRect;
+
+typedef struct {
+  int width, height;
+  unsigned char *pixels;    // width * height * TEX_STAGE_BPP bytes, first row first
+  texRect dirty;            // width 0 when nothing changed
+} texStage;
+
+bool texStageInit(texStage *stage, int width, int height);
+void texStageFree(texStage *stage);
+// Copies a width x height block of pixels, rows srcStride bytes apart, to (x, y), and
+//  marks it dirty. Returns false (copying nothing) if the block isn't within the texture.
+bool texStageWrite(texStage *stage, const unsigned char *src, size_t srcStride, int x, int y, int width, int height);
+void texStageMarkDirty(texStage *stage, int x, int y, int width, int height);
+// Returns false if nothing is dirty, else the dirty rectangle, which is then cleared
+bool texStageTakeDirty(texStage *stage, texRect *rect);
+// Copies rect to dst, rows packed (rect->width * TEX_STAGE_BPP bytes each)
+void texStageCopyRect(const texStage *stage, const texRect *rect, unsigned char *dst);
+
+#endif
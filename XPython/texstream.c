@@ -0,0 +1,178 @@
+#define _GNU_SOURCE 1
+#include <Python.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#if IBM
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#if APL
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMGraphics.h>
+#include "texstream.h"
+
+/*
+ * Streamed textures.
+ *
+ * Uploads go through two pixel buffer objects used in turn: the dirty rectangle is
+ * copied into one while the driver may still be transferring the other (last frame's)
+ * to the texture, so neither python nor the frame waits on the copy. The buffer is
+ * re-specified before mapping, so the driver can hand us fresh storage rather than
+ * block on a transfer in flight.
+ *
+ * Buffer object functions are past OpenGL 1.1 (all that windows' opengl32 exports) so
+ * are looked up at run time. Without them, we upload straight from the staging copy.
+ */
+
+const char *texStreamRefName = "XPLMTextureStreamRef";
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+
+typedef void (APIENTRY *genBuffersFun)(GLsizei n, GLuint *buffers);
+typedef void (APIENTRY *deleteBuffersFun)(GLsizei n, const GLuint *buffers);
+typedef void (APIENTRY *bindBufferFun)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *bufferDataFun)(GLenum target, ptrdiff_t size, const void *data, GLenum usage);
+typedef void *(APIENTRY *mapBufferFun)(GLenum target, GLenum access);
+typedef GLboolean (APIENTRY *unmapBufferFun)(GLenum target);
+
+static struct {
+  bool loaded, ok;
+  genBuffersFun genBuffers;
+  deleteBuffersFun deleteBuffers;
+  bindBufferFun bindBuffer;
+  bufferDataFun bufferData;
+  mapBufferFun mapBuffer;
+  unmapBufferFun unmapBuffer;
+} gl;
+
+static void *glFunction(const char *name)
+{
+#if IBM
+  return (void *)wglGetProcAddress(name);
+#else
+  return dlsym(RTLD_DEFAULT, name);
+#endif
+}
+
+static bool texStreamLoadGL(void)
+{
+  if(!gl.loaded){
+    gl.loaded = true;
+    gl.genBuffers = (genBuffersFun)glFunction("glGenBuffers");
+    gl.deleteBuffers = (deleteBuffersFun)glFunction("glDeleteBuffers");
+    gl.bindBuffer = (bindBufferFun)glFunction("glBindBuffer");
+    gl.bufferData = (bufferDataFun)glFunction("glBufferData");
+    gl.mapBuffer = (mapBufferFun)glFunction("glMapBuffer");
+    gl.unmapBuffer = (unmapBufferFun)glFunction("glUnmapBuffer");
+    gl.ok = gl.genBuffers && gl.deleteBuffers && gl.bindBuffer && gl.bufferData && gl.mapBuffer && gl.unmapBuffer;
+  }
+  return gl.ok;
+}
+
+struct texStream {
+  int textureID;
+  int format;
+  texStage stage;
+  GLuint pbo[2];
+  int nextPbo;
+  bool allocated;           // texture storage set to our size
+};
+
+static void texStreamFree(PyObject *capsule)
+{
+  texStream *stream = (texStream *)PyCapsule_GetPointer(capsule, texStreamRefName);
+  if(stream){
+    if(stream->pbo[0] && texStreamLoadGL()){
+      gl.deleteBuffers(2, stream->pbo);
+    }
+    texStageFree(&stream->stage);
+    free(stream);
+  }
+}
+
+PyObject *texStreamNewObj(int textureID, int width, int height, int format)
+{
+  texStream *stream = (texStream *)calloc(1, sizeof(texStream));
+  if(!stream || !texStageInit(&stream->stage, width, height)){
+    free(stream);
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate texture stream.");
+    return NULL;
+  }
+  stream->textureID = textureID;
+  stream->format = format;
+  PyObject *res = PyCapsule_New(stream, texStreamRefName, texStreamFree);
+  if(!res){
+    texStageFree(&stream->stage);
+    free(stream);
+  }
+  return res;
+}
+
+texStream *texStreamFromObj(PyObject *obj)
+{
+  return (texStream *)PyCapsule_GetPointer(obj, texStreamRefName);
+}
+
+texStage *texStreamStage(texStream *stream)
+{
+  return &stream->stage;
+}
+
+bool texStreamUpload(texStream *stream)
+{
+  texRect rect;
+  if(!texStageTakeDirty(&stream->stage, &rect)){
+    return false;
+  }
+  GLenum format = stream->format == TEX_STREAM_BGRA8 ? GL_BGRA : GL_RGBA;
+  XPLMBindTexture2d(stream->textureID, 0);
+  if(!stream->allocated){
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, stream->stage.width, stream->stage.height, 0, format, GL_UNSIGNED_BYTE, NULL);
+    stream->allocated = true;
+  }
+
+  if(texStreamLoadGL()){
+    if(!stream->pbo[0]){
+      gl.genBuffers(2, stream->pbo);
+    }
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, stream->pbo[stream->nextPbo]);
+    stream->nextPbo ^= 1;
+    gl.bufferData(GL_PIXEL_UNPACK_BUFFER, (ptrdiff_t)rect.width * rect.height * TEX_STAGE_BPP, NULL, GL_STREAM_DRAW);
+    unsigned char *dst = (unsigned char *)gl.mapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if(dst){
+      texStageCopyRect(&stream->stage, &rect, dst);
+      gl.unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      // with a pixel unpack buffer bound, the data pointer is an offset into it
+      glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, format, GL_UNSIGNED_BYTE, NULL);
+      gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return true;
+    }
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  const unsigned char *src = stream->stage.pixels + ((size_t)rect.y * stream->stage.width + rect.x) * TEX_STAGE_BPP;
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, stream->stage.width);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, format, GL_UNSIGNED_BYTE, src);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  return true;
+}
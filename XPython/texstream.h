@@ -0,0 +1,25 @@
+#ifndef TEXSTREAM__H
+#define TEXSTREAM__H
+
+#include <Python.h>
+#include <stdbool.h>
+#include "texstage.h"
+
+/* Texture updated from python buffers: pixels are written to a staging copy, and the
+   dirty part uploaded within a draw callback through alternating pixel buffer objects. */
+typedef struct texStream texStream;
+
+// Pixel formats, as xplmTexFormat_* in XPLMGraphics
+#define TEX_STREAM_RGBA8 0
+#define TEX_STREAM_BGRA8 1
+
+extern const char *texStreamRefName;
+
+PyObject *texStreamNewObj(int textureID, int width, int height, int format);
+texStream *texStreamFromObj(PyObject *obj);
+texStage *texStreamStage(texStream *stream);
+// Sends dirty pixels to the texture. Call with a GL context (from a draw callback).
+//  Returns false if nothing was dirty.
+bool texStreamUpload(texStream *stream);
+
+#endif
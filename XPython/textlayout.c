@@ -0,0 +1,331 @@
+#define _GNU_SOURCE 1
+#include <Python.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMGraphics.h>
+#include "textlayout.h"
+
+/*
+ * Text layout cache.
+ *
+ * A layout is the text split into lines (on newlines, and on spaces to fit the wrap
+ * width), with each line's measured width. Layouts live in a fixed array, found through
+ * a hash table on (string hash, font, wrap width) and kept in least-recently-used order;
+ * the string hash is the one python caches in the str object. A hit compares the text,
+ * so changed content simply gets a new layout, and identical text is never measured twice
+ * while cached. Evicted slots keep their buffers for reuse.
+ */
+
+#define TEXT_LAYOUT_DEFAULT_CAPACITY 256
+
+struct textLayout {
+  Py_hash_t hash;
+  XPLMFontID font;
+  int wrapWidth;
+  char *text;               // key, as utf-8
+  Py_ssize_t textLen, textMax;
+  char *lineText;           // copy of text, with NUL at the end of each line
+  int *lineStart;           // offsets into lineText
+  float *lineWidth;
+  int numLines, maxLines;
+  float width;              // widest line
+  int fontHeight;
+  int prev, next;           // LRU list, most recently used at layoutHead
+  int hnext;                // hash chain
+};
+
+static textLayout *layouts = NULL;
+static int layoutCapacity = TEXT_LAYOUT_DEFAULT_CAPACITY;
+static int layoutCount;
+static int *layoutBuckets = NULL;
+static unsigned int layoutBucketMask;
+static int layoutHead = -1, layoutTail = -1;
+static long layoutHits, layoutMisses;
+
+static unsigned int layoutHash(Py_hash_t hash, XPLMFontID font, int wrapWidth)
+{
+  return ((unsigned int)hash ^ (unsigned int)font * 73856093u ^ (unsigned int)wrapWidth * 19349663u) & layoutBucketMask;
+}
+
+static void layoutFreeSlots(void)
+{
+  for(int i = 0; layouts && i < layoutCapacity; ++i){
+    free(layouts[i].text);
+    free(layouts[i].lineText);
+    free(layouts[i].lineStart);
+    free(layouts[i].lineWidth);
+  }
+  free(layouts);
+  free(layoutBuckets);
+  layouts = NULL;
+  layoutBuckets = NULL;
+}
+
+bool textLayoutConfigure(int capacity)
+{
+  if(capacity < 1){
+    return false;
+  }
+  unsigned int buckets = 1;
+  while(buckets < (unsigned int)capacity * 2){
+    buckets <<= 1;
+  }
+  textLayout *slots = (textLayout *)calloc(capacity, sizeof(textLayout));
+  int *bucketArray = (int *)malloc(buckets * sizeof(int));
+  if(!slots || !bucketArray){
+    free(slots);
+    free(bucketArray);
+    return false;
+  }
+  layoutFreeSlots();
+  layouts = slots;
+  layoutBuckets = bucketArray;
+  memset(layoutBuckets, 0xff, buckets * sizeof(int));
+  layoutBucketMask = buckets - 1;
+  layoutCapacity = capacity;
+  layoutCount = 0;
+  layoutHead = layoutTail = -1;
+  layoutHits = layoutMisses = 0;
+  return true;
+}
+
+static void layoutUnlink(int idx)
+{
+  textLayout *layout = &layouts[idx];
+  if(layout->prev >= 0){
+    layouts[layout->prev].next = layout->next;
+  }else{
+    layoutHead = layout->next;
+  }
+  if(layout->next >= 0){
+    layouts[layout->next].prev = layout->prev;
+  }else{
+    layoutTail = layout->prev;
+  }
+}
+
+static void layoutPushFront(int idx)
+{
+  textLayout *layout = &layouts[idx];
+  layout->prev = -1;
+  layout->next = layoutHead;
+  if(layoutHead >= 0){
+    layouts[layoutHead].prev = idx;
+  }
+  layoutHead = idx;
+  if(layoutTail < 0){
+    layoutTail = idx;
+  }
+}
+
+static void layoutUnhash(int idx)
+{
+  textLayout *layout = &layouts[idx];
+  int *link = &layoutBuckets[layoutHash(layout->hash, layout->font, layout->wrapWidth)];
+  while(*link >= 0){
+    if(*link == idx){
+      *link = layout->hnext;
+      return;
+    }
+    link = &layouts[*link].hnext;
+  }
+}
+
+static bool layoutAddLine(textLayout *layout, int start, int end, float width)
+{
+  if(layout->numLines == layout->maxLines){
+    int newMax = layout->maxLines ? layout->maxLines * 2 : 16;
+    int *starts = (int *)realloc(layout->lineStart, newMax * sizeof(int));
+    if(!starts){
+      return false;
+    }
+    layout->lineStart = starts;
+    float *widths = (float *)realloc(layout->lineWidth, newMax * sizeof(float));
+    if(!widths){
+      return false;
+    }
+    layout->lineWidth = widths;
+    layout->maxLines = newMax;
+  }
+  layout->lineText[end] = '\0';
+  layout->lineStart[layout->numLines] = start;
+  layout->lineWidth[layout->numLines] = width;
+  ++layout->numLines;
+  if(width > layout->width){
+    layout->width = width;
+  }
+  return true;
+}
+
+// Splits text into lines. Words are broken only on spaces, so a word wider than
+//  the wrap width gets a line of its own.
+static bool layoutBuild(textLayout *layout)
+{
+  char *s = layout->lineText;
+  int len = (int)layout->textLen;
+  memcpy(s, layout->text, len + 1);
+  layout->numLines = 0;
+  layout->width = 0.0f;
+  XPLMGetFontDimensions(layout->font, NULL, &layout->fontHeight, NULL);
+
+  int p = 0;
+  while(true){
+    char *nl = memchr(s + p, '\n', len - p);
+    int end = nl ? (int)(nl - s) : len;
+    if(layout->wrapWidth <= 0){
+      if(!layoutAddLine(layout, p, end, XPLMMeasureString(layout->font, s + p, end - p))){
+        return false;
+      }
+    }else{
+      int lineStart = p, lineEnd = p, cur = p;
+      float lineWidth = 0.0f;
+      while(cur < end){
+        int wordEnd = cur;
+        while(wordEnd < end && s[wordEnd] != ' '){
+          ++wordEnd;
+        }
+        float width = XPLMMeasureString(layout->font, s + lineStart, wordEnd - lineStart);
+        if(width > layout->wrapWidth && lineEnd > lineStart){
+          // s[lineEnd] is the space before this word
+          if(!layoutAddLine(layout, lineStart, lineEnd, lineWidth)){
+            return false;
+          }
+          lineStart = lineEnd = cur;
+          lineWidth = 0.0f;
+          continue;
+        }
+        lineEnd = wordEnd;
+        lineWidth = width;
+        cur = wordEnd < end ? wordEnd + 1 : wordEnd;
+      }
+      if(!layoutAddLine(layout, lineStart, lineEnd, lineWidth)){
+        return false;
+      }
+    }
+    if(end == len){
+      break;
+    }
+    p = end + 1;
+  }
+  return true;
+}
+
+textLayout *textLayoutGet(PyObject *text, XPLMFontID font, int wrapWidth)
+{
+  if(!layouts && !textLayoutConfigure(layoutCapacity)){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate text layout cache.");
+    return NULL;
+  }
+  Py_ssize_t len;
+  const char *str = PyUnicode_AsUTF8AndSize(text, &len);
+  if(!str){
+    return NULL;
+  }
+  Py_hash_t hash = PyObject_Hash(text);
+  if(hash == -1){
+    return NULL;
+  }
+  if(wrapWidth < 0){
+    wrapWidth = 0;
+  }
+  unsigned int h = layoutHash(hash, font, wrapWidth);
+  for(int idx = layoutBuckets[h]; idx >= 0; idx = layouts[idx].hnext){
+    textLayout *layout = &layouts[idx];
+    if(layout->hash == hash && layout->font == font && layout->wrapWidth == wrapWidth
+       && layout->textLen == len && memcmp(layout->text, str, len) == 0){
+      if(idx != layoutHead){
+        layoutUnlink(idx);
+        layoutPushFront(idx);
+      }
+      ++layoutHits;
+      return layout;
+    }
+  }
+
+  ++layoutMisses;
+  int idx;
+  if(layoutCount < layoutCapacity){
+    idx = layoutCount++;
+  }else{
+    idx = layoutTail;
+    layoutUnlink(idx);
+    layoutUnhash(idx);
+  }
+  textLayout *layout = &layouts[idx];
+  if(len + 1 > layout->textMax){
+    char *newText = (char *)realloc(layout->text, len + 1);
+    char *newLines = newText ? (char *)realloc(layout->lineText, len + 1) : NULL;
+    if(newText){
+      layout->text = newText;
+    }
+    if(newLines){
+      layout->lineText = newLines;
+      layout->textMax = len + 1;
+    }
+  }
+  layout->hash = hash;
+  layout->font = font;
+  layout->wrapWidth = wrapWidth;
+  layout->textLen = len;
+  bool ok = len + 1 <= layout->textMax;
+  if(ok){
+    memcpy(layout->text, str, len + 1);
+    ok = layoutBuild(layout);
+  }
+  if(!ok){
+    // slot stays in the LRU list, but not in the hash table, so it never matches
+    layout->textLen = -1;
+    layout->hnext = -1;
+    layoutPushFront(idx);
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate text layout.");
+    return NULL;
+  }
+  layout->hnext = layoutBuckets[h];
+  layoutBuckets[h] = idx;
+  layoutPushFront(idx);
+  return layout;
+}
+
+void textLayoutExtent(const textLayout *layout, float *width, int *lineHeight, int *numLines)
+{
+  *width = layout->width;
+  *lineHeight = layout->fontHeight;
+  *numLines = layout->numLines;
+}
+
+const char *textLayoutLine(const textLayout *layout, int line, float *width)
+{
+  *width = layout->lineWidth[line];
+  return layout->lineText + layout->lineStart[line];
+}
+
+int textLayoutDraw(const textLayout *layout, float *rgb, int left, int top, int lineHeight)
+{
+  if(lineHeight <= 0){
+    lineHeight = layout->fontHeight;
+  }
+  for(int i = 0; i < layout->numLines; ++i){
+    XPLMDrawString(rgb, left, top - (i + 1) * lineHeight, layout->lineText + layout->lineStart[i], NULL, layout->font);
+  }
+  return layout->numLines;
+}
+
+void textLayoutStats(long *hits, long *misses, int *size, int *capacity)
+{
+  *hits = layoutHits;
+  *misses = layoutMisses;
+  *size = layouts ? layoutCount : 0;
+  *capacity = layoutCapacity;
+}
+
+void textLayoutCleanup(void)
+{
+  layoutFreeSlots();
+  layoutCount = 0;
+  layoutHead = layoutTail = -1;
+  layoutHits = layoutMisses = 0;
+  layoutCapacity = TEXT_LAYOUT_DEFAULT_CAPACITY;
+}
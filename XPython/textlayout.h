@@ -0,0 +1,24 @@
+#ifndef TEXTLAYOUT__H
+#define TEXTLAYOUT__H
+
+#include <Python.h>
+#include <stdbool.h>
+#include <XPLM/XPLMDefs.h>
+#include <XPLM/XPLMGraphics.h>
+
+/* Cache of measured and line-broken text, keyed by (string, font, wrap width), so panels
+   redrawn every frame measure their text only when it changes. */
+typedef struct textLayout textLayout;
+
+bool textLayoutConfigure(int capacity);
+// Returns the layout of text (a str), building it if needed. The layout is owned by the
+//  cache, and valid until the next call. Returns NULL with exception set on error.
+textLayout *textLayoutGet(PyObject *text, XPLMFontID font, int wrapWidth);
+void textLayoutExtent(const textLayout *layout, float *width, int *lineHeight, int *numLines);
+const char *textLayoutLine(const textLayout *layout, int line, float *width);
+// Draws lines top-down from (left, top), lineHeight 0 meaning the font's height. Returns lines drawn.
+int textLayoutDraw(const textLayout *layout, float *rgb, int left, int top, int lineHeight);
+void textLayoutStats(long *hits, long *misses, int *size, int *capacity);
+void textLayoutCleanup(void);
+
+#endif
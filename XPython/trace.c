@@ -0,0 +1,212 @@
+#define _GNU_SOURCE 1
+#include <Python.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "trace.h"
+
+/*
+ * Callback dispatch tracer.
+ *
+ * Every trampoline which calls into python brackets the call with traceBegin() / traceEnd().
+ * While tracing is enabled, events are written into a ring buffer allocated once in
+ * traceStart(), so recording never allocates. When the buffer is full, oldest events
+ * are overwritten. traceDump() writes the buffer as Chrome trace-event JSON, which can
+ * be loaded into chrome://tracing or https://ui.perfetto.dev.
+ *
+ * All XPLM callbacks arrive on the sim's main thread, so a single buffer serves as the
+ * per-thread buffer; events are tagged with tid 1.
+ */
+
+#define TRACE_MAX_NAMES 256
+
+typedef struct {
+  int64_t ts;         // microseconds since traceStart()
+  void *refcon;
+  uint16_t name;      // index into traceNames
+  uint8_t kind;
+  char phase;         // 'B' or 'E'
+} traceEvent;
+
+bool traceEnabled = false;
+
+static traceEvent *traceBuffer = NULL;
+static Py_ssize_t traceCapacity;
+static Py_ssize_t traceHead;   // next slot to be written
+static Py_ssize_t traceCount;  // number of valid events (<= traceCapacity)
+static int64_t traceEpoch;
+
+static char *traceNames[TRACE_MAX_NAMES] = {"unknown"};
+static int traceNameCount = 1;
+
+static const char *traceKindNames[traceKindCount] = {
+  "flightLoop", "draw", "keySniffer", "hotKey", "window", "widget",
+  "accessor", "command", "menu", "map", "camera"
+};
+
+static int64_t traceNow(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static uint16_t traceNameIndex(PyObject *plugin, PyObject *callable)
+{
+  // Only called while tracing; PyUnicode_AsUTF8 caches its result in the object, so
+  //  repeated lookups of the same pluginSelf are cheap.
+  PyObject *module = NULL;
+  const char *name = NULL;
+  if(plugin && PyUnicode_Check(plugin)){
+    name = PyUnicode_AsUTF8(plugin);
+  }else if(callable){
+    module = PyObject_GetAttrString(callable, "__module__");
+    if(module && PyUnicode_Check(module)){
+      name = PyUnicode_AsUTF8(module);
+    }
+  }
+  if(PyErr_Occurred()){
+    PyErr_Clear();
+  }
+  uint16_t res = 0;
+  if(name != NULL){
+    int i;
+    for(i = 1; i < traceNameCount; ++i){
+      if(strcmp(traceNames[i], name) == 0){
+        res = i;
+        break;
+      }
+    }
+    if(i == traceNameCount && traceNameCount < TRACE_MAX_NAMES){
+      traceNames[traceNameCount] = strdup(name);
+      res = traceNameCount++;
+    }
+  }
+  Py_XDECREF(module);
+  return res;
+}
+
+static void traceRecord(char phase, traceKind kind, uint16_t name, void *refcon)
+{
+  traceEvent *ev = &traceBuffer[traceHead];
+  ev->ts = traceNow() - traceEpoch;
+  ev->refcon = refcon;
+  ev->name = name;
+  ev->kind = (uint8_t)kind;
+  ev->phase = phase;
+  if(++traceHead == traceCapacity){
+    traceHead = 0;
+  }
+  if(traceCount < traceCapacity){
+    ++traceCount;
+  }
+}
+
+void traceBegin(traceKind kind, PyObject *plugin, PyObject *callable, void *refcon)
+{
+  if(!traceEnabled){
+    return;
+  }
+  traceRecord('B', kind, traceNameIndex(plugin, callable), refcon);
+}
+
+void traceEnd(traceKind kind, void *refcon)
+{
+  if(!traceEnabled){
+    return;
+  }
+  traceRecord('E', kind, 0, refcon);
+}
+
+bool traceStart(Py_ssize_t capacity)
+{
+  if(capacity <= 0){
+    return false;
+  }
+  if(traceBuffer == NULL || capacity != traceCapacity){
+    traceEvent *buffer = (traceEvent *)realloc(traceBuffer, capacity * sizeof(traceEvent));
+    if(buffer == NULL){
+      return false;
+    }
+    traceBuffer = buffer;
+    traceCapacity = capacity;
+  }
+  traceHead = 0;
+  traceCount = 0;
+  traceEpoch = traceNow();
+  traceEnabled = true;
+  return true;
+}
+
+void traceStop(void)
+{
+  traceEnabled = false;
+}
+
+static void traceWriteString(FILE *f, const char *str)
+{
+  fputc('"', f);
+  for(; *str; ++str){
+    if(*str == '"' || *str == '\\'){
+      fputc('\\', f);
+      fputc(*str, f);
+    }else if((unsigned char)*str < 0x20){
+      fprintf(f, "\\u%04x", (unsigned char)*str);
+    }else{
+      fputc(*str, f);
+    }
+  }
+  fputc('"', f);
+}
+
+long traceDump(const char *fname)
+{
+  FILE *f = fopen(fname, "w");
+  if(f == NULL){
+    return -1;
+  }
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  Py_ssize_t start = (traceHead - traceCount + traceCapacity) % (traceCapacity ? traceCapacity : 1);
+  // names of the end events are taken from the matching begin event
+  uint16_t stack[256];
+  int depth = 0;
+  for(Py_ssize_t i = 0; i < traceCount; ++i){
+    traceEvent *ev = &traceBuffer[(start + i) % traceCapacity];
+    uint16_t name = ev->name;
+    if(ev->phase == 'B'){
+      if(depth < 256){
+        stack[depth] = name;
+      }
+      ++depth;
+    }else if(depth > 0){
+      --depth;
+      if(depth < 256){
+        name = stack[depth];
+      }
+    }
+    fprintf(f, "%s{\"name\":", i ? ",\n" : "");
+    traceWriteString(f, traceNames[name]);
+    fprintf(f, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":1,\"args\":{\"refcon\":\"%p\"}}",
+            traceKindNames[ev->kind], ev->phase, (long long)ev->ts, ev->refcon);
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+  return (long)traceCount;
+}
+
+void traceCleanup(void)
+{
+  traceEnabled = false;
+  free(traceBuffer);
+  traceBuffer = NULL;
+  traceCapacity = 0;
+  traceHead = 0;
+  traceCount = 0;
+  for(int i = 1; i < traceNameCount; ++i){
+    free(traceNames[i]);
+    traceNames[i] = NULL;
+  }
+  traceNameCount = 1;
+}
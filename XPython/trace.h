@@ -0,0 +1,36 @@
+#ifndef TRACE__H
+#define TRACE__H
+
+#include <Python.h>
+#include <stdbool.h>
+
+/* Kinds of callback dispatch recorded by the tracer; used as the
+   Chrome trace-event "cat" field. */
+typedef enum {
+  traceFlightLoop = 0,
+  traceDraw,
+  traceKeySniffer,
+  traceHotKey,
+  traceWindow,
+  traceWidget,
+  traceAccessor,
+  traceCommand,
+  traceMenu,
+  traceMap,
+  traceCamera,
+  traceKindCount
+} traceKind;
+
+extern bool traceEnabled;
+
+bool traceStart(Py_ssize_t capacity);
+void traceStop(void);
+long traceDump(const char *fname);
+void traceCleanup(void);
+
+// plugin is the pluginSelf stored with the callback (may be NULL), callable is used
+//  to find the owning module when plugin is not available
+void traceBegin(traceKind kind, PyObject *plugin, PyObject *callable, void *refcon);
+void traceEnd(traceKind kind, void *refcon);
+
+#endif
@@ -5,14 +5,38 @@
 #include <stdbool.h>
 #include <XPLM/XPLMDefs.h>
 #include <XPLM/XPLMUtilities.h>
+#include <XPLM/XPLMProcessing.h>
 #include "utils.h"
+#include "trace.h"
 
 PyObject *errCallbacks;
 PyObject *commandCallbacks;
-PyObject *commandRefcons;
 PyObject *commandCapsules;
 intptr_t commandCallbackCntr;
 
+// Registered command handler. The record is the refcon given to X-Plane, so commandCallback()
+//  has everything it needs to call python without any lookup. commandCallbacks holds the same
+//  information, keyed by the record's index, for XPPythonGetDicts().
+typedef struct commandHandler {
+  XPLMCommandRef command;
+  PyObject *commandObj;       // capsule passed to the handler
+  PyObject *handler;
+  PyObject *refcon;
+  PyObject *pluginSelf;
+  PyObject *key;
+  int before;
+  unsigned int phases;        // bit per wanted phase
+  float continueInterval;     // minimum seconds between Continue calls, 0 for every frame
+  float lastContinue;
+  int lastResult;             // answer to phases not sent to python
+  int busy;                   // calls in progress, the handler may unregister itself
+  bool removed;
+  struct commandHandler *next;
+} commandHandler;
+
+static commandHandler *commandHandlers = NULL;
+static PyObject *commandPhases[xplm_CommandEnd + 1];
+
 static void error_callback(const char *inMessage)
 {
   //TODO: send the error only to the active plugin?
@@ -302,36 +326,80 @@ static PyObject *XPLMSaveDataFileFun(PyObject *self, PyObject *args)
   return PyLong_FromLong(res);
 }
 
+static void commandHandlerFree(commandHandler *info)
+{
+  if(PyDict_DelItem(commandCallbacks, info->key)){
+    PyErr_Clear();
+  }
+  Py_DECREF(info->key);
+  Py_DECREF(info->commandObj);
+  Py_DECREF(info->handler);
+  Py_DECREF(info->refcon);
+  Py_DECREF(info->pluginSelf);
+  free(info);
+}
+
 static int commandCallback(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
-  PyObject *pID = PyLong_FromVoidPtr(inRefcon);
-  PyObject *pCbk = PyDict_GetItem(commandCallbacks, pID);
-  if(pCbk == NULL){
-    printf("Received unknown commandCallback refCon (%p).\n", inRefcon);
-    return -1;
-  }
-  //0 - self, 1 - callback, 2 - refcon
-  PyObject *arg1 = getPtrRef(inCommand, commandCapsules, commandRefName);
-  PyObject *arg2 = PyLong_FromLong(inPhase);
-  PyObject *oRes = PyObject_CallFunctionObjArgs(PyTuple_GetItem(pCbk, 2), arg1, arg2, PyTuple_GetItem(pCbk, 4), NULL);
-  Py_DECREF(arg1);
-  Py_DECREF(arg2);
-  PyObject *err = PyErr_Occurred();
-  char msg[1024];
-  if(err){
-    sprintf(msg, "Error in CommandCallback %s", objToStr(PyTuple_GetItem(pCbk, 2)));
-    PyErr_SetString(err, msg);
-    PyErr_Print();
+  (void) inCommand;
+  commandHandler *info = (commandHandler *)inRefcon;
+  // Phases the handler doesn't want, and throttled Continues, are answered here with
+  //  the handler's latest result, so a before handler keeps blocking a held command.
+  if(inPhase == xplm_CommandBegin){
+    info->lastResult = 1;
+    info->lastContinue = XPLMGetElapsedTime();
+  }
+  if(inPhase >= xplm_CommandBegin && inPhase <= xplm_CommandEnd && !(info->phases & (1u << inPhase))){
+    return info->lastResult;
+  }
+  if(inPhase == xplm_CommandContinue && info->continueInterval > 0.0f){
+    float now = XPLMGetElapsedTime();
+    if(now - info->lastContinue < info->continueInterval){
+      return info->lastResult;
+    }
+    info->lastContinue = now;
   }
-  Py_DECREF(pID);
-  int res = PyLong_AsLong(oRes);
-  err = PyErr_Occurred();
-  if(err){
-    sprintf(msg, "Expected integer for return from CommandCallback %s", objToStr(PyTuple_GetItem(pCbk, 2)));
-    PyErr_SetString(err, msg);
+  PyObject *phase;
+  if(inPhase >= xplm_CommandBegin && inPhase <= xplm_CommandEnd){
+    phase = commandPhases[inPhase];
+    Py_INCREF(phase);
+  }else{
+    phase = PyLong_FromLong(inPhase);
+  }
+  PyObject *handler = info->handler;
+  PyObject *args[] = {info->commandObj, phase, info->refcon};
+  ++info->busy;
+  traceBegin(traceCommand, info->pluginSelf, handler, inRefcon);
+  PyObject *oRes = callVector(handler, args, 3);
+  traceEnd(traceCommand, inRefcon);
+  Py_DECREF(phase);
+
+  int res = 1;
+  const char *msg = NULL;
+  if(!oRes){
+    msg = "Error in CommandCallback %s";
+  }else{
+    res = PyLong_AsLong(oRes);
+    Py_DECREF(oRes);
+    if(res == -1 && PyErr_Occurred()){
+      msg = "Expected integer for return from CommandCallback %s";
+      res = 1;
+    }
+  }
+  info->lastResult = res;
+  if(msg){
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    char *handlerStr = objToStr(handler);
+    PyErr_Restore(type, value, traceback);
+    fprintf(pythonLogFile, msg, handlerStr);
+    fprintf(pythonLogFile, "\n");
+    free(handlerStr);
     PyErr_Print();
   }
-  Py_DECREF(oRes);
+  if(--info->busy == 0 && info->removed){
+    commandHandlerFree(info);
+  }
   return res;
 }
 
@@ -398,22 +466,63 @@ static PyObject *XPLMRegisterCommandHandlerFun(PyObject *self, PyObject *args)
   PyObject *inHandler;
   int inBefore;
   PyObject *inRefcon;
-  PyObject *pluginSelf;
-  if(!PyArg_ParseTuple(args, "OOiO", &inCommand, &inHandler, &inBefore, &inRefcon))
+  PyObject *inPhases = Py_None;
+  float inContinueInterval = 0.0f;
+  if(!PyArg_ParseTuple(args, "OOiO|Of", &inCommand, &inHandler, &inBefore, &inRefcon, &inPhases, &inContinueInterval))
     return NULL;
-  pluginSelf = get_pluginSelf();
-  intptr_t refcon = commandCallbackCntr++;
-  XPLMRegisterCommandHandler(refToPtr(inCommand, commandRefName), commandCallback, inBefore, (void *)refcon);
-
-  PyObject *rc = PyLong_FromVoidPtr((void *)refcon);
-  PyObject *irc = PyLong_FromVoidPtr((void *)inCommand);
-  PyDict_SetItem(commandRefcons, irc, rc);
-
-  PyObject *argsObj = Py_BuildValue( "(OOOiO)", pluginSelf, inCommand, inHandler, inBefore, inRefcon);
-  PyDict_SetItem(commandCallbacks, rc, argsObj);
+  unsigned int phases = 0;
+  if(inPhases == Py_None){
+    phases = (1u << xplm_CommandBegin) | (1u << xplm_CommandContinue) | (1u << xplm_CommandEnd);
+  }else{
+    PyObject *seq = PySequence_Fast(inPhases, "Command phases must be None or a sequence of phases.");
+    if(!seq){
+      return NULL;
+    }
+    for(Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i){
+      long phase = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+      if(phase < xplm_CommandBegin || phase > xplm_CommandEnd){
+        Py_DECREF(seq);
+        if(!PyErr_Occurred()){
+          PyErr_Format(PyExc_ValueError, "Unknown command phase %ld.", phase);
+        }
+        return NULL;
+      }
+      phases |= 1u << phase;
+    }
+    Py_DECREF(seq);
+  }
+  XPLMCommandRef command = refToPtr(inCommand, commandRefName);
+  if(!command){
+    if(!PyErr_Occurred()){
+      PyErr_SetString(PyExc_ValueError, "XPLMRegisterCommandHandler: command is None.");
+    }
+    return NULL;
+  }
+  commandHandler *info = (commandHandler *)calloc(1, sizeof(commandHandler));
+  if(!info){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate command handler.");
+    return NULL;
+  }
+  info->command = command;
+  info->commandObj = getPtrRef(command, commandCapsules, commandRefName);
+  Py_INCREF(inHandler);
+  info->handler = inHandler;
+  Py_INCREF(inRefcon);
+  info->refcon = inRefcon;
+  info->pluginSelf = get_pluginSelf();
+  info->before = inBefore;
+  info->phases = phases;
+  info->continueInterval = inContinueInterval;
+  info->lastResult = 1;
+  info->key = PyLong_FromVoidPtr((void *)commandCallbackCntr++);
+
+  PyObject *argsObj = Py_BuildValue( "(OOOiO)", info->pluginSelf, inCommand, inHandler, inBefore, inRefcon);
+  PyDict_SetItem(commandCallbacks, info->key, argsObj);
   Py_DECREF(argsObj);
-  Py_DECREF(rc);
-  Py_DECREF(irc);
+
+  info->next = commandHandlers;
+  commandHandlers = info;
+  XPLMRegisterCommandHandler(command, commandCallback, inBefore, info);
   Py_RETURN_NONE;
 }
 
@@ -426,17 +535,35 @@ static PyObject *XPLMUnregisterCommandHandlerFun(PyObject *self, PyObject *args)
   PyObject *inRefcon;
   if(!PyArg_ParseTuple(args, "OOiO", &inCommand, &inHandler, &inBefore, &inRefcon))
     return NULL;
-  PyObject *key = PyLong_FromVoidPtr((void *)inCommand);
-  PyObject *refcon = PyDict_GetItem(commandRefcons, key);
-  XPLMUnregisterCommandHandler(refToPtr(inCommand, commandRefName), commandCallback,
-                               inBefore, PyLong_AsVoidPtr(refcon));
-  if(PyDict_DelItem(commandRefcons, key)){
-    printf("XPLMUnregisterCommandHandler: couldn't remove refcon.\n");
+  XPLMCommandRef command = refToPtr(inCommand, commandRefName);
+  if(PyErr_Occurred()){
+    return NULL;
   }
-  Py_DECREF(key);
-  if(PyDict_DelItem(commandCallbacks, refcon)){
-    printf("XPLMUnregisterCommandHandler: couldn't remove command handler.\n");
+  // handlers are usually bound methods, which are equal but not identical each time
+  for(commandHandler **prev = &commandHandlers; *prev; prev = &(*prev)->next){
+    commandHandler *info = *prev;
+    if(info->command != command || info->before != inBefore){
+      continue;
+    }
+    int match = PyObject_RichCompareBool(info->handler, inHandler, Py_EQ);
+    if(match > 0){
+      match = PyObject_RichCompareBool(info->refcon, inRefcon, Py_EQ);
+    }
+    if(match < 0){
+      return NULL;
+    }
+    if(match){
+      XPLMUnregisterCommandHandler(command, commandCallback, inBefore, info);
+      *prev = info->next;
+      if(info->busy){
+        info->removed = true;
+      }else{
+        commandHandlerFree(info);
+      }
+      Py_RETURN_NONE;
+    }
   }
+  printf("XPLMUnregisterCommandHandler: couldn't remove command handler.\n");
   Py_RETURN_NONE;
 }
 
@@ -446,10 +573,17 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
   (void) args;
   PyDict_Clear(errCallbacks);
   Py_DECREF(errCallbacks);
+  while(commandHandlers){
+    commandHandler *info = commandHandlers;
+    commandHandlers = info->next;
+    XPLMUnregisterCommandHandler(info->command, commandCallback, info->before, info);
+    commandHandlerFree(info);
+  }
+  for(int i = xplm_CommandBegin; i <= xplm_CommandEnd; ++i){
+    Py_CLEAR(commandPhases[i]);
+  }
   PyDict_Clear(commandCallbacks);
   Py_DECREF(commandCallbacks);
-  PyDict_Clear(commandRefcons);
-  Py_DECREF(commandRefcons);
   PyDict_Clear(commandCapsules);
   Py_DECREF(commandCapsules);
   Py_RETURN_NONE;
@@ -516,10 +650,11 @@ PyInit_XPLMUtilities(void)
     return NULL;
   }
   PyDict_SetItemString(xppythonDicts, "commandCallbacks", commandCallbacks);
-  if(!(commandRefcons = PyDict_New())){
-    return NULL;
+  for(int i = xplm_CommandBegin; i <= xplm_CommandEnd; ++i){
+    if(!(commandPhases[i] = PyLong_FromLong(i))){
+      return NULL;
+    }
   }
-  PyDict_SetItemString(xppythonDicts, "commandRefcons", commandRefcons);
   if(!(commandCapsules = PyDict_New())){
     return NULL;
   }
@@ -140,6 +140,48 @@ void removePtrRef(void *ptr, PyObject *dict)
   Py_DECREF(key);
 }
 
+// Gets C-contiguous buffer of float ('f'), double ('d') or int ('i') items from any object
+//   supporting the buffer protocol (array.array, numpy array, memoryview, ...).
+// Returns number of items, or -1 with exception set. On success, release with PyBuffer_Release().
+Py_ssize_t getTypedBuffer(PyObject *obj, Py_buffer *view, char type, bool writable, const char *name)
+{
+  Py_ssize_t itemSize = type == 'd' ? sizeof(double) : (type == 'f' ? sizeof(float) : sizeof(int));
+  int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+  if(PyObject_GetBuffer(obj, view, flags) < 0){
+    PyErr_Format(PyExc_TypeError, "%s must be a contiguous%s buffer of '%c'", name, writable ? " writable" : "", type);
+    return -1;
+  }
+  const char *fmt = view->format ? view->format : "B";
+  if(*fmt == '@' || *fmt == '=' || *fmt == '<'){
+    ++fmt;
+  }
+  bool ok = fmt[0] != '\0' && fmt[1] == '\0' && view->itemsize == itemSize;
+  if(type == 'i'){
+    ok = ok && (fmt[0] == 'i' || fmt[0] == 'l');
+  }else{
+    ok = ok && fmt[0] == type;
+  }
+  if(!ok){
+    PyErr_Format(PyExc_TypeError, "%s must be a buffer of '%c', not '%s'", name, type, view->format ? view->format : "B");
+    PyBuffer_Release(view);
+    return -1;
+  }
+  return view->len / itemSize;
+}
+
+// Calls callable with a C array of positional arguments, without building an argument tuple
+//   (vectorcall on 3.8+, fastcall before).
+PyObject *callVector(PyObject *callable, PyObject *const *args, size_t nargs)
+{
+#if PY_VERSION_HEX >= 0x03090000
+  return PyObject_Vectorcall(callable, args, nargs, NULL);
+#elif PY_VERSION_HEX >= 0x03080000
+  return _PyObject_Vectorcall(callable, args, nargs, NULL);
+#else
+  return _PyObject_FastCall(callable, (PyObject **)args, (Py_ssize_t)nargs);
+#endif
+}
+
 /* char *get_module(PyThreadState *tstate) { */
 /*   /\* returns filename of top most frame -- this will be the Plugin's file *\/ */
 /*   char *last_filename = "[unknown]"; */
@@ -22,6 +22,8 @@ PyObject *getPtrRef(void *ptr, PyObject *dict, const char *refName);
 PyObject *getPtrRefOneshot(void *ptr, const char *refName);
 void *refToPtr(PyObject *ref, const char *refName);
 void removePtrRef(void *ptr, PyObject *dict);
+Py_ssize_t getTypedBuffer(PyObject *obj, Py_buffer *view, char type, bool writable, const char *name);
+PyObject *callVector(PyObject *callable, PyObject *const *args, size_t nargs);
 char *get_module(PyThreadState *tstate);
 PyObject *get_pluginSelf(/*PyThreadState *tstate*/);
 char *objToStr(PyObject *item);
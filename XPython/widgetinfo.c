@@ -0,0 +1,299 @@
+#define _GNU_SOURCE 1
+#include <Python.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <Widgets/XPWidgetDefs.h>
+#include "widgetinfo.h"
+
+/*
+ * Per-widget C state.
+ *
+ * widgetCallback() runs for every message sent to a widget with a python callback,
+ * including draw, cursor adjust and mouse drag which arrive constantly. Records here
+ * are found with a pointer hash on the XPWidgetID, so messages nobody subscribed to
+ * can be dropped before any python object is looked up or built.
+ *
+ * Records also hold widget user properties, which are python objects X-Plane can't
+ * store. Looking one up costs a hash lookup and a scan of the widget's few properties,
+ * with no allocation.
+ *
+ * Records are created when the first python callback or user property is attached to
+ * a widget (along with widgetCallback(), so we see the widget's xpMsg_Destroy), and
+ * removed on xpMsg_Destroy (or XPDestroyWidget).
+ */
+
+static widgetInfo **widgetInfoBuckets = NULL;
+static size_t widgetInfoNumBuckets = 0;
+static size_t widgetInfoCount = 0;
+
+static size_t widgetInfoHash(XPWidgetID widget, size_t numBuckets)
+{
+  uintptr_t h = (uintptr_t)widget;
+  h ^= h >> 17;
+  h *= 0x9E3779B1u;
+  h ^= h >> 13;
+  return h & (numBuckets - 1);
+}
+
+static bool widgetInfoGrow(void)
+{
+  size_t newNum = widgetInfoNumBuckets ? widgetInfoNumBuckets * 2 : 64;
+  widgetInfo **buckets = (widgetInfo **)calloc(newNum, sizeof(widgetInfo *));
+  if(!buckets){
+    return false;
+  }
+  for(size_t i = 0; i < widgetInfoNumBuckets; ++i){
+    widgetInfo *info = widgetInfoBuckets[i];
+    while(info){
+      widgetInfo *next = info->next;
+      size_t h = widgetInfoHash(info->widget, newNum);
+      info->next = buckets[h];
+      buckets[h] = info;
+      info = next;
+    }
+  }
+  free(widgetInfoBuckets);
+  widgetInfoBuckets = buckets;
+  widgetInfoNumBuckets = newNum;
+  return true;
+}
+
+bool widgetMaskFromObj(PyObject *obj, widgetMsgMask *mask)
+{
+  // None means every message; otherwise an iterable of message IDs
+  memset(mask, 0, sizeof(widgetMsgMask));
+  if(obj == NULL || obj == Py_None){
+    mask->all = true;
+    return true;
+  }
+  PyObject *seq = PySequence_Fast(obj, "Widget message mask must be None or a sequence of messages.");
+  if(!seq){
+    return false;
+  }
+  Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+  for(Py_ssize_t i = 0; i < len; ++i){
+    long message = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+    if(message == -1 && PyErr_Occurred()){
+      Py_DECREF(seq);
+      return false;
+    }
+    if(message >= 0 && message < 64){
+      mask->bits |= (uint64_t)1 << message;
+    }else if(!widgetMaskWants(mask, (int)message)){
+      if(mask->numExtra == WIDGET_MASK_EXTRA){
+        Py_DECREF(seq);
+        PyErr_Format(PyExc_ValueError, "Widget message mask is limited to %d messages outside 0..63.", WIDGET_MASK_EXTRA);
+        return false;
+      }
+      mask->extra[mask->numExtra++] = (int)message;
+    }
+  }
+  Py_DECREF(seq);
+  return true;
+}
+
+bool widgetMaskWants(const widgetMsgMask *mask, int message)
+{
+  if(mask->all){
+    return true;
+  }
+  if(message >= 0 && message < 64){
+    return (mask->bits & ((uint64_t)1 << message)) != 0;
+  }
+  for(int i = 0; i < mask->numExtra; ++i){
+    if(mask->extra[i] == message){
+      return true;
+    }
+  }
+  return false;
+}
+
+static void widgetMaskUnion(widgetMsgMask *into, const widgetMsgMask *mask)
+{
+  if(into->all || mask->all){
+    into->all = true;
+    return;
+  }
+  into->bits |= mask->bits;
+  for(int i = 0; i < mask->numExtra; ++i){
+    if(widgetMaskWants(into, mask->extra[i])){
+      continue;
+    }
+    if(into->numExtra == WIDGET_MASK_EXTRA){
+      // too many to track, stop filtering
+      into->all = true;
+      return;
+    }
+    into->extra[into->numExtra++] = mask->extra[i];
+  }
+}
+
+widgetInfo *widgetInfoGet(XPWidgetID widget)
+{
+  if(widgetInfoNumBuckets == 0){
+    return NULL;
+  }
+  widgetInfo *info = widgetInfoBuckets[widgetInfoHash(widget, widgetInfoNumBuckets)];
+  while(info && info->widget != widget){
+    info = info->next;
+  }
+  return info;
+}
+
+widgetInfo *widgetInfoCreate(XPWidgetID widget, PyObject *callbacks)
+{
+  widgetInfo *info = widgetInfoGet(widget);
+  if(info){
+    return info;
+  }
+  if(widgetInfoCount >= widgetInfoNumBuckets && !widgetInfoGrow()){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget info.");
+    return NULL;
+  }
+  info = (widgetInfo *)calloc(1, sizeof(widgetInfo));
+  if(!info){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget info.");
+    return NULL;
+  }
+  info->widget = widget;
+  Py_INCREF(callbacks);
+  info->callbacks = callbacks;
+  size_t h = widgetInfoHash(widget, widgetInfoNumBuckets);
+  info->next = widgetInfoBuckets[h];
+  widgetInfoBuckets[h] = info;
+  ++widgetInfoCount;
+  return info;
+}
+
+bool widgetInfoPushMask(widgetInfo *info, const widgetMsgMask *mask)
+{
+  // callbacks are inserted at the front of the list, so are masks
+  if(info->numMasks == info->maxMasks){
+    Py_ssize_t newMax = info->maxMasks ? info->maxMasks * 2 : 2;
+    widgetMsgMask *masks = (widgetMsgMask *)realloc(info->masks, newMax * sizeof(widgetMsgMask));
+    if(!masks){
+      PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget message mask.");
+      return false;
+    }
+    info->masks = masks;
+    info->maxMasks = newMax;
+  }
+  memmove(info->masks + 1, info->masks, info->numMasks * sizeof(widgetMsgMask));
+  info->masks[0] = *mask;
+  ++info->numMasks;
+  widgetMaskUnion(&info->any, mask);
+  return true;
+}
+
+PyObject *widgetInfoGetProperty(widgetInfo *info, int property)
+{
+  for(int i = 0; i < info->numProps; ++i){
+    if(info->props[i].property == property){
+      return info->props[i].value;
+    }
+  }
+  return NULL;
+}
+
+static int widgetPropertyEqual(PyObject *a, PyObject *b)
+{
+  // fast paths for the usual property values, avoiding rich comparison
+  if(a == b){
+    return 1;
+  }
+  if(PyLong_CheckExact(a) && PyLong_CheckExact(b)){
+    int overflowA, overflowB;
+    long la = PyLong_AsLongAndOverflow(a, &overflowA);
+    long lb = PyLong_AsLongAndOverflow(b, &overflowB);
+    if(!overflowA && !overflowB){
+      return la == lb;
+    }
+  }else if(PyFloat_CheckExact(a) && PyFloat_CheckExact(b)){
+    return PyFloat_AS_DOUBLE(a) == PyFloat_AS_DOUBLE(b);
+  }else if(PyUnicode_CheckExact(a) && PyUnicode_CheckExact(b)){
+    if(PyUnicode_GET_LENGTH(a) != PyUnicode_GET_LENGTH(b)){
+      return 0;
+    }
+    return PyUnicode_Compare(a, b) == 0;
+  }
+  return PyObject_RichCompareBool(a, b, Py_EQ);
+}
+
+int widgetInfoSetProperty(widgetInfo *info, int property, PyObject *value)
+{
+  for(int i = 0; i < info->numProps; ++i){
+    if(info->props[i].property == property){
+      PyObject *prev = info->props[i].value;
+      int equal = widgetPropertyEqual(value, prev);
+      if(equal < 0){
+        return -1;
+      }
+      Py_INCREF(value);
+      info->props[i].value = value;
+      Py_DECREF(prev);
+      return !equal;
+    }
+  }
+  if(info->numProps == info->maxProps){
+    int newMax = info->maxProps ? info->maxProps * 2 : 4;
+    widgetProperty *props = (widgetProperty *)realloc(info->props, newMax * sizeof(widgetProperty));
+    if(!props){
+      PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget property.");
+      return -1;
+    }
+    info->props = props;
+    info->maxProps = newMax;
+  }
+  Py_INCREF(value);
+  info->props[info->numProps].property = property;
+  info->props[info->numProps].value = value;
+  ++info->numProps;
+  return 1;
+}
+
+static void widgetInfoFree(widgetInfo *info)
+{
+  for(int i = 0; i < info->numProps; ++i){
+    Py_DECREF(info->props[i].value);
+  }
+  free(info->props);
+  Py_XDECREF(info->callbacks);
+  free(info->masks);
+  free(info);
+}
+
+void widgetInfoRemove(XPWidgetID widget)
+{
+  if(widgetInfoNumBuckets == 0){
+    return;
+  }
+  widgetInfo **prev = &widgetInfoBuckets[widgetInfoHash(widget, widgetInfoNumBuckets)];
+  while(*prev){
+    widgetInfo *info = *prev;
+    if(info->widget == widget){
+      *prev = info->next;
+      --widgetInfoCount;
+      widgetInfoFree(info);
+      return;
+    }
+    prev = &info->next;
+  }
+}
+
+void widgetInfoCleanup(void)
+{
+  for(size_t i = 0; i < widgetInfoNumBuckets; ++i){
+    widgetInfo *info = widgetInfoBuckets[i];
+    while(info){
+      widgetInfo *next = info->next;
+      widgetInfoFree(info);
+      info = next;
+    }
+  }
+  free(widgetInfoBuckets);
+  widgetInfoBuckets = NULL;
+  widgetInfoNumBuckets = 0;
+  widgetInfoCount = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef WIDGETINFO__H
+#define WIDGETINFO__H
+
+#include <Python.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <Widgets/XPWidgetDefs.h>
+
+/* Per-widget state kept in C for widgets with python callbacks, found by XPWidgetID
+   without going through the capsule dictionaries. */
+
+#define WIDGET_MASK_EXTRA 8
+
+// Set of widget messages a callback subscribes to. Messages below 64 are kept as bits,
+//  others (standard widget and user messages) in a short list.
+typedef struct {
+  bool all;
+  uint64_t bits;
+  int extra[WIDGET_MASK_EXTRA];
+  int numExtra;
+} widgetMsgMask;
+
+// User property (>= xpProperty_UserStart) value
+typedef struct {
+  int property;
+  PyObject *value;
+} widgetProperty;
+
+typedef struct widgetInfo {
+  XPWidgetID widget;
+  PyObject *callbacks;        // same list as in widgetCallbackDict, first callback first
+  widgetMsgMask *masks;       // one per callback, in the same order
+  Py_ssize_t numMasks, maxMasks;
+  widgetMsgMask any;          // union of masks
+  widgetProperty *props;
+  int numProps, maxProps;
+  struct widgetInfo *next;
+} widgetInfo;
+
+bool widgetMaskFromObj(PyObject *obj, widgetMsgMask *mask);
+bool widgetMaskWants(const widgetMsgMask *mask, int message);
+
+widgetInfo *widgetInfoGet(XPWidgetID widget);
+widgetInfo *widgetInfoCreate(XPWidgetID widget, PyObject *callbacks);
+bool widgetInfoPushMask(widgetInfo *info, const widgetMsgMask *mask);
+// Returns a borrowed reference, or NULL if the property isn't set
+PyObject *widgetInfoGetProperty(widgetInfo *info, int property);
+// Returns 1 if the value changed (or is new), 0 if equal to the previous value, -1 on error
+int widgetInfoSetProperty(widgetInfo *info, int property, PyObject *value);
+void widgetInfoRemove(XPWidgetID widget);
+void widgetInfoCleanup(void);
+
+// In widgets.c: find or create the record of a widget, hooking widgetCallback()
+widgetInfo *widgetInfoAttach(PyObject *widget, XPWidgetID wid);
+bool widgetAddCallback(PyObject *widget, XPWidgetID wid, PyObject *callback, PyObject *messages);
+bool widgetAddCallbackMask(PyObject *widget, XPWidgetID wid, PyObject *callback, const widgetMsgMask *mask);
+bool widgetSetUserProperty(PyObject *widget, XPWidgetID wid, int property, PyObject *value);
+
+#endif
@@ -11,25 +11,25 @@
 #include <Widgets/XPStandardWidgets.h>
 #include "plugin_dl.h"
 #include "utils.h"
+#include "trace.h"
+#include "widgetinfo.h"
 
 static PyObject *widgetCallbackDict;
-static PyObject *widgetPropertyDict;
 PyObject *widgetIDCapsules;
 
-int widgetCallback(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inParam1, intptr_t inParam2)
+static void widgetCallbackArgs(XPWidgetMessage inMessage, intptr_t inParam1, intptr_t inParam2,
+                               PyObject **param1, PyObject **param2)
 {
-  PyObject *widget = getPtrRef(inWidget, widgetIDCapsules, widgetRefName);
-  PyObject *param1, *param2;
   XPKeyState_t *keyState;
   XPMouseState_t *mouseState;
   XPWidgetGeometryChange_t *wChange;
-  param1 = PyLong_FromLong(inParam1);
-  param2 = PyLong_FromLong(inParam2);
+  *param1 = NULL;
+  *param2 = NULL;
   switch(inMessage){
   case xpMsg_KeyPress:
     keyState = (XPKeyState_t *)inParam1;
-    param1 = Py_BuildValue("(iii)", (int)keyState->key, (int)keyState->flags,
-                           (int)keyState->vkey);
+    *param1 = Py_BuildValue("(iii)", (int)keyState->key, (int)keyState->flags,
+                            (int)keyState->vkey);
     break;
   case xpMsg_MouseDown:
   case xpMsg_MouseDrag:
@@ -37,14 +37,14 @@ int widgetCallback(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inPa
   case xpMsg_MouseWheel:
   case xpMsg_CursorAdjust:
     mouseState = (XPMouseState_t *)inParam1;
-    param1 = Py_BuildValue("(iiii)", mouseState->x, mouseState->y,
-                           mouseState->button, mouseState->delta);
+    *param1 = Py_BuildValue("(iiii)", mouseState->x, mouseState->y,
+                            mouseState->button, mouseState->delta);
     break;
   case xpMsg_Reshape:
-    param1 =  getPtrRef((void *)inParam1, widgetIDCapsules, widgetRefName);
+    *param1 =  getPtrRef((void *)inParam1, widgetIDCapsules, widgetRefName);
     wChange = (XPWidgetGeometryChange_t *)inParam2;
-    param2 = Py_BuildValue("(iiii)", wChange->dx, wChange->dy,
-                           wChange->dwidth, wChange->dheight);
+    *param2 = Py_BuildValue("(iiii)", wChange->dx, wChange->dy,
+                            wChange->dwidth, wChange->dheight);
     break;
   case xpMsg_AcceptChild:
   case xpMsg_LoseChild:
@@ -54,47 +54,74 @@ int widgetCallback(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inPa
   case xpMsg_TextFieldChanged:
   case xpMsg_PushButtonPressed:
   case xpMsg_ButtonStateChanged:
-    param1 =  getPtrRef((void *)inParam1, widgetIDCapsules, widgetRefName);
+    *param1 =  getPtrRef((void *)inParam1, widgetIDCapsules, widgetRefName);
     break;
     
   case xpMsg_PropertyChanged:
     if (inParam1 >= xpProperty_UserStart) {
       // use inParam2 -- it's already python
-      param2 = (PyObject*)inParam2;
+      *param2 = (PyObject*)inParam2;
+      Py_INCREF(*param2);
     }
     break;
   default: // intentionally empty
     break;
   }
+  if(*param1 == NULL){
+    *param1 = PyLong_FromLong(inParam1);
+  }
+  if(*param2 == NULL){
+    *param2 = PyLong_FromLong(inParam2);
+  }
+}
 
-  PyObject *callbackList = PyDict_GetItem(widgetCallbackDict, widget);
-  if(callbackList == NULL){
-    /* we'll get an xpMsg_Create that we can't handle from a CustomWidget (because the widgetCallbackDict
+int widgetCallback(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inParam1, intptr_t inParam2)
+{
+  widgetInfo *info = widgetInfoGet(inWidget);
+  if(info == NULL){
+    /* we'll get an xpMsg_Create that we can't handle from a CustomWidget (because the widget info
        isn't populated yet). Ignore the message (CreateCustomWidget() below will send it again!)
        If not xpMsg_Create, write error.
      */
     if (inMessage != xpMsg_Create) {
       fprintf(pythonLogFile, "Couldn't find the callback list for widget ID %p. for message %d\n", inWidget, inMessage);
     }
-    Py_DECREF(widget);
-    Py_DECREF(param1);
-    Py_DECREF(param2);
     return 0;
   }
+  if(inMessage != xpMsg_Destroy && !widgetMaskWants(&info->any, inMessage)){
+    // no callback subscribed to this message: skip building python arguments
+    return 0;
+  }
+
+  // python arguments are built only once a python callback wants the message
+  PyObject *widget = NULL, *param1 = NULL, *param2 = NULL;
+  PyObject *callbackList = info->callbacks;
+  Py_INCREF(callbackList);
 
   Py_ssize_t i;
-  int res;
+  int res = 0;
   PyObject *callback;
   for(i = 0; i < PyList_Size(callbackList); ++i){
     callback = PyList_GetItem(callbackList, i);
+    // look up again, a previous callback may have destroyed the widget
+    info = widgetInfoGet(inWidget);
+    if(info && i < info->numMasks && !widgetMaskWants(&info->masks[i], inMessage)){
+      continue;
+    }
     //Have to differentiate between python callbacks and "binary" function callbacks
     // (like the ones returned by XPGetWidgetClassFunc)
     if(PyLong_Check(callback)){
       XPWidgetFunc_t cFunc = (XPWidgetFunc_t)PyLong_AsVoidPtr(callback);
       res = cFunc(inMessage, inWidget, inParam1, inParam2);
     }else{
+      if(widget == NULL){
+        widget = getPtrRef(inWidget, widgetIDCapsules, widgetRefName);
+        widgetCallbackArgs(inMessage, inParam1, inParam2, &param1, &param2);
+      }
       PyObject *inMessageObj = PyLong_FromLong(inMessage);
+      traceBegin(traceWidget, NULL, callback, inWidget);
       PyObject *resObj = PyObject_CallFunctionObjArgs(callback, inMessageObj, widget, param1, param2, NULL);
+      traceEnd(traceWidget, inWidget);
       Py_DECREF(inMessageObj);
       if(!resObj){
         PyErr_Print();
@@ -104,7 +131,7 @@ int widgetCallback(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inPa
       Py_DECREF(resObj);
     }
     if(res != 0){
-      if(inMessage == xpMsg_CursorAdjust){
+      if(inMessage == xpMsg_CursorAdjust && param2 != NULL){
         *(XPLMCursorStatus *)inParam2 = (int)PyLong_AsLong(param2);
       }
       break;
@@ -112,19 +139,81 @@ int widgetCallback(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inPa
   }
 
   if(inMessage == xpMsg_Destroy){
-    PyDict_DelItem(widgetCallbackDict, widget);
+    if(widget == NULL){
+      widget = getPtrRef(inWidget, widgetIDCapsules, widgetRefName);
+    }
+    if(PyDict_GetItem(widgetCallbackDict, widget)){
+      PyDict_DelItem(widgetCallbackDict, widget);
+    }
+    widgetInfoRemove(inWidget);
   }
 
-  Py_DECREF(widget);
-  Py_DECREF(param1);
-  if (inMessage != xpMsg_PropertyChanged || inParam1 < xpProperty_UserStart) {
-    Py_DECREF(param2);
-  }
+  Py_DECREF(callbackList);
+  Py_XDECREF(widget);
+  Py_XDECREF(param1);
+  Py_XDECREF(param2);
   return res;
 }
 
 
 
+// Finds the C record of a widget, or creates it (with an empty callback list) and hooks
+//  widgetCallback() so the record is freed on xpMsg_Destroy.
+widgetInfo *widgetInfoAttach(PyObject *widget, XPWidgetID wid)
+{
+  widgetInfo *info = widgetInfoGet(wid);
+  if(info){
+    return info;
+  }
+  PyObject *callbackList = PyList_New(0);
+  if(!callbackList){
+    return NULL;
+  }
+  PyDict_SetItem(widgetCallbackDict, widget, callbackList);
+  info = widgetInfoCreate(wid, callbackList);
+  Py_DECREF(callbackList);
+  if(info){
+    XPAddWidgetCallback(wid, widgetCallback);
+  }
+  return info;
+}
+
+bool widgetAddCallbackMask(PyObject *widget, XPWidgetID wid, PyObject *callback, const widgetMsgMask *mask)
+{
+  //widgetCallback is registered only the first time
+  widgetInfo *info = widgetInfoAttach(widget, wid);
+  if(!info || !widgetInfoPushMask(info, mask)){
+    return false;
+  }
+  return PyList_Insert(info->callbacks, 0, callback) == 0;
+}
+
+bool widgetAddCallback(PyObject *widget, XPWidgetID wid, PyObject *callback, PyObject *messages)
+{
+  widgetMsgMask mask;
+  if(!widgetMaskFromObj(messages, &mask)){
+    return false;
+  }
+  return widgetAddCallbackMask(widget, wid, callback, &mask);
+}
+
+bool widgetSetUserProperty(PyObject *widget, XPWidgetID wid, int property, PyObject *value)
+{
+  widgetInfo *info = widgetInfoAttach(widget, wid);
+  if(!info){
+    return false;
+  }
+  int changed = widgetInfoSetProperty(info, property, value);
+  if(changed < 0){
+    return false;
+  }
+  if(changed){
+    /* not found, or they're different */
+    XPSendMessageToWidget(wid, xpMsg_PropertyChanged, xpMode_Direct, property, (intptr_t) value);
+  }
+  return true;
+}
+
 static PyObject *XPCreateWidgetFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -155,8 +244,13 @@ static PyObject *XPCreateCustomWidgetFun(PyObject *self, PyObject *args)
   const char *inDescriptor;
   PyObject *container;
   PyObject *inCallback;
-  if(!PyArg_ParseTuple(args, "iiiiisiOO", &inLeft, &inTop, &inRight, &inBottom, &inVisible, &inDescriptor,
-                       &inIsRoot, &container, &inCallback)){
+  PyObject *messages = Py_None;
+  if(!PyArg_ParseTuple(args, "iiiiisiOO|O", &inLeft, &inTop, &inRight, &inBottom, &inVisible, &inDescriptor,
+                       &inIsRoot, &container, &inCallback, &messages)){
+    return NULL;
+  }
+  widgetMsgMask mask;
+  if(!widgetMaskFromObj(messages, &mask)){
     return NULL;
   }
   // use inContainer 0, if passed in value of 0
@@ -178,6 +272,12 @@ static PyObject *XPCreateCustomWidgetFun(PyObject *self, PyObject *args)
   PyObject *callbackList = PyList_New(0);
   PyList_Insert(callbackList, 0, inCallback);
   PyDict_SetItem(widgetCallbackDict, resObj, callbackList);
+  widgetInfo *info = widgetInfoCreate(res, callbackList);
+  Py_DECREF(callbackList);
+  if(!info || !widgetInfoPushMask(info, &mask)){
+    Py_DECREF(resObj);
+    return NULL;
+  }
   XPSendMessageToWidget(res, xpMsg_Create, xpMode_Direct, 0, 0);
   return resObj;
 }
@@ -196,6 +296,7 @@ static PyObject *XPDestroyWidgetFun(PyObject *self, PyObject *args)
   if(w){
     PyDict_DelItem(widgetCallbackDict, widget);
   }
+  widgetInfoRemove(wid);
   removePtrRef(wid, widgetIDCapsules);
   Py_RETURN_NONE;
 }
@@ -441,19 +542,8 @@ static PyObject *XPSetWidgetPropertyFun(PyObject *self, PyObject *args)
   }
   XPWidgetPropertyID inProperty = property;
   if (property >= xpProperty_UserStart) {
-    PyObject *key = Py_BuildValue("(Oi)", widget, property);
-
-    PyObject *prevValueObj = PyDict_GetItem(widgetPropertyDict, key);
-    PyDict_SetItem(widgetPropertyDict, key, value);
-
-    int comparison = 0; /* false */
-    if (prevValueObj != NULL) {
-      /* value value, do comparison */
-      comparison = PyObject_RichCompareBool(value, prevValueObj, Py_EQ);
-    }
-    if (comparison == 0) {
-      /* not found, or they're different */
-      XPSendMessageToWidget(refToPtr(widget, widgetRefName), xpMsg_PropertyChanged, xpMode_Direct, property, (intptr_t) value);
+    if (!widgetSetUserProperty(widget, refToPtr(widget, widgetRefName), property, value)) {
+      return NULL;
     }
   } else {
     XPSetWidgetProperty(refToPtr(widget, widgetRefName), inProperty, PyLong_AsLong(value));
@@ -474,8 +564,8 @@ static PyObject *XPGetWidgetPropertyFun(PyObject *self, PyObject *args)
 
   PyObject *resObj;
   if (property >= xpProperty_UserStart) {
-    PyObject *key = Py_BuildValue("(Oi)", widget, property);
-    resObj = PyDict_GetItem(widgetPropertyDict, key);
+    widgetInfo *info = widgetInfoGet(refToPtr(widget, widgetRefName));
+    resObj = info ? widgetInfoGetProperty(info, property) : NULL;
     if (resObj == NULL) {
       /* not found, return 0 */
       resObj = PyLong_FromLong(0);
@@ -484,7 +574,6 @@ static PyObject *XPGetWidgetPropertyFun(PyObject *self, PyObject *args)
       Py_INCREF(resObj);
       inExists = 1;
     }
-    Py_DECREF(key);
   } else {
     intptr_t res = XPGetWidgetProperty(refToPtr(widget, widgetRefName), inProperty, &inExists);
     resObj = PyLong_FromLong(res);
@@ -537,18 +626,12 @@ static PyObject *XPAddWidgetCallbackFun(PyObject *self, PyObject *args)
 {
   (void) self;
   PyObject *widget, *callback;
-  if (!PyArg_ParseTuple(args, "OO", &widget, &callback)){
+  PyObject *messages = Py_None;
+  if (!PyArg_ParseTuple(args, "OO|O", &widget, &callback, &messages)){
     return NULL;
   }
-  PyObject *current = PyDict_GetItem(widgetCallbackDict, widget);
-  if(current == NULL){
-    current = PyList_New(0);
-    PyList_Append(current, callback);
-    PyDict_SetItem(widgetCallbackDict, widget, current);
-    //register only the first time
-    XPAddWidgetCallback(refToPtr(widget, widgetRefName), widgetCallback);
-  }else{
-    PyList_Insert(current, 0, callback);
+  if(!widgetAddCallback(widget, refToPtr(widget, widgetRefName), callback, messages)){
+    return NULL;
   }
   Py_RETURN_NONE;
 }
@@ -568,10 +651,9 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
 {
   (void) self;
   (void) args;
+  widgetInfoCleanup();
   PyDict_Clear(widgetCallbackDict);
   Py_DECREF(widgetCallbackDict);
-  PyDict_Clear(widgetPropertyDict);
-  Py_DECREF(widgetPropertyDict);
   PyDict_Clear(widgetIDCapsules);
   Py_DECREF(widgetIDCapsules);
   Py_RETURN_NONE;
@@ -629,10 +711,6 @@ PyInit_XPWidgets(void)
     return NULL;
   }
   PyDict_SetItemString(xppythonDicts, "widgetCallbacks", widgetCallbackDict);
-  if(!(widgetPropertyDict = PyDict_New())){
-    return NULL;
-  }
-  PyDict_SetItemString(xppythonDicts, "widgetProperties", widgetPropertyDict);
   if(!(widgetIDCapsules = PyDict_New())){
     return NULL;
   }
@@ -2,6 +2,7 @@
 #include <Python.h>
 #include <sys/time.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 
 #include <XPLM/XPLMDefs.h>
@@ -10,6 +11,7 @@
 #include <Widgets/XPWidgetUtils.h>
 #include <Widgets/XPStandardWidgets.h>
 #include "utils.h"
+#include "widgetinfo.h"
 
 static PyObject *XPUCreateWidgetsFun(PyObject *self, PyObject *args)
 {
@@ -56,6 +58,284 @@ static PyObject *XPUCreateWidgetsFun(PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+/* Each row of XPUCreateWidgetTree defs is {left, top, right, bottom, visible, isRoot, containerIndex, widgetClass} */
+#define WIDGET_TREE_COLS 8
+/* Each row of XPUCreateWidgetTree properties is {widgetIndex, property, value} */
+#define WIDGET_TREE_PROP_COLS 3
+
+typedef struct {
+  int index;
+  PyObject *callback;
+  widgetMsgMask mask;
+} widgetTreeCallback;
+
+typedef struct {
+  int index;
+  int property;
+  PyObject *value;
+  long intValue;
+} widgetTreeUserProp;
+
+static PyObject *XPUCreateWidgetTreeFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  PyObject *defsObj, *descriptorsObj, *paramParent = Py_None, *propsObj = Py_None;
+  PyObject *userPropsObj = Py_None, *callbacksObj = Py_None;
+  if(!PyArg_ParseTuple(args, "OO|OOOO", &defsObj, &descriptorsObj, &paramParent, &propsObj,
+                       &userPropsObj, &callbacksObj)){
+    return NULL;
+  }
+  XPWidgetID inParamParent = NULL;
+  if(paramParent != Py_None){
+    inParamParent = refToPtr(paramParent, widgetRefName);
+    if(PyErr_Occurred()){
+      return NULL;
+    }
+  }
+
+  Py_buffer defsView, propsView = {0}, text = {0};
+  Py_ssize_t cnt = getTypedBuffer(defsObj, &defsView, 'i', false, "XPUCreateWidgetTree defs");
+  if(cnt < 0){
+    return NULL;
+  }
+  PyObject *seq = NULL, *userProps = NULL, *callbacks = NULL, *res = NULL;
+  XPWidgetCreate_t *defs = NULL;
+  XPWidgetID *ioWidgets = NULL;
+  const int *prop = NULL;
+  Py_ssize_t numProps = 0;
+  widgetTreeCallback *treeCallbacks = NULL;
+  widgetTreeUserProp *treeUserProps = NULL;
+  Py_ssize_t numCallbacks = 0, numUserProps = 0;
+  bool created = false;
+  if(cnt % WIDGET_TREE_COLS){
+    PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree defs must have 8 ints per widget");
+    goto cleanup;
+  }
+  cnt /= WIDGET_TREE_COLS;
+
+  // Descriptors are either a sequence of str, or one bytes-like buffer of NUL terminated strings
+  const char *textPtr = NULL, *textEnd = NULL;
+  if(PyUnicode_Check(descriptorsObj) || !PyObject_CheckBuffer(descriptorsObj)){
+    seq = PySequence_Fast(descriptorsObj, "XPUCreateWidgetTree descriptors must be a sequence of str or a bytes-like object");
+    if(!seq){
+      goto cleanup;
+    }
+    if(PySequence_Fast_GET_SIZE(seq) < cnt){
+      PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree has fewer descriptors than widgets");
+      goto cleanup;
+    }
+  }else{
+    if(PyObject_GetBuffer(descriptorsObj, &text, PyBUF_SIMPLE) < 0){
+      goto cleanup;
+    }
+    textPtr = (const char *)text.buf;
+    textEnd = textPtr + text.len;
+  }
+
+  if(propsObj != Py_None){
+    numProps = getTypedBuffer(propsObj, &propsView, 'i', false, "XPUCreateWidgetTree properties");
+    if(numProps < 0){
+      goto cleanup;
+    }
+    if(numProps % WIDGET_TREE_PROP_COLS){
+      PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree properties must have 3 ints per property");
+      goto cleanup;
+    }
+    numProps /= WIDGET_TREE_PROP_COLS;
+    prop = (const int *)propsView.buf;
+    for(Py_ssize_t i = 0; i < numProps; ++i){
+      if(prop[i * WIDGET_TREE_PROP_COLS] < 0 || prop[i * WIDGET_TREE_PROP_COLS] >= cnt){
+        PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree property widget index out of range");
+        goto cleanup;
+      }
+    }
+  }
+  // Callbacks and user properties are parsed before anything is created, so bad entries
+  //  don't leave a half configured tree behind.
+  if(userPropsObj != Py_None){
+    userProps = PySequence_Fast(userPropsObj, "XPUCreateWidgetTree userProperties must be a sequence of (index, property, value)");
+    if(!userProps){
+      goto cleanup;
+    }
+    numUserProps = PySequence_Fast_GET_SIZE(userProps);
+    if(numUserProps && !(treeUserProps = (widgetTreeUserProp *)calloc(numUserProps, sizeof(widgetTreeUserProp)))){
+      PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget tree.");
+      goto cleanup;
+    }
+    for(Py_ssize_t i = 0; i < numUserProps; ++i){
+      widgetTreeUserProp *u = &treeUserProps[i];
+      PyObject *value;
+      if(!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(userProps, i), "iiO", &u->index, &u->property, &value)){
+        goto cleanup;
+      }
+      if(u->index < 0 || u->index >= cnt){
+        PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree user property widget index out of range");
+        goto cleanup;
+      }
+      if(u->property < xpProperty_UserStart){
+        u->intValue = PyLong_AsLong(value);
+        if(u->intValue == -1 && PyErr_Occurred()){
+          goto cleanup;
+        }
+      }
+      Py_INCREF(value);
+      u->value = value;
+    }
+  }
+  if(callbacksObj != Py_None){
+    callbacks = PySequence_Fast(callbacksObj, "XPUCreateWidgetTree callbacks must be a sequence of (index, callback[, messages])");
+    if(!callbacks){
+      goto cleanup;
+    }
+    numCallbacks = PySequence_Fast_GET_SIZE(callbacks);
+    if(numCallbacks && !(treeCallbacks = (widgetTreeCallback *)calloc(numCallbacks, sizeof(widgetTreeCallback)))){
+      PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget tree.");
+      goto cleanup;
+    }
+    for(Py_ssize_t i = 0; i < numCallbacks; ++i){
+      widgetTreeCallback *c = &treeCallbacks[i];
+      PyObject *callback, *messages = Py_None;
+      if(!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(callbacks, i), "iO|O", &c->index, &callback, &messages)){
+        goto cleanup;
+      }
+      if(c->index < 0 || c->index >= cnt){
+        PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree callback widget index out of range");
+        goto cleanup;
+      }
+      if(!widgetMaskFromObj(messages, &c->mask)){
+        goto cleanup;
+      }
+      Py_INCREF(callback);
+      c->callback = callback;
+    }
+  }
+
+  defs = (XPWidgetCreate_t *)malloc(cnt * sizeof(XPWidgetCreate_t));
+  ioWidgets = (XPWidgetID *)malloc(cnt * sizeof(XPWidgetID));
+  if(cnt && (!defs || !ioWidgets)){
+    PyErr_SetString(PyExc_RuntimeError, "Can't allocate widget tree.");
+    goto cleanup;
+  }
+  const int *row = (const int *)defsView.buf;
+  for(Py_ssize_t i = 0; i < cnt; ++i, row += WIDGET_TREE_COLS){
+    const char *str;
+    if(seq){
+      str = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+      if(!str){
+        goto cleanup;
+      }
+    }else{
+      str = textPtr;
+      const char *nul = textPtr < textEnd ? memchr(textPtr, '\0', textEnd - textPtr) : NULL;
+      if(!nul){
+        PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree has fewer NUL terminated descriptors than widgets");
+        goto cleanup;
+      }
+      textPtr = nul + 1;
+    }
+    // XPUCreateWidgets looks up the container while creating, so it must come earlier
+    int containerIndex = row[6];
+    if(containerIndex != NO_PARENT && containerIndex != PARAM_PARENT && (containerIndex < 0 || containerIndex >= i)){
+      PyErr_SetString(PyExc_ValueError, "XPUCreateWidgetTree container index must be an earlier widget");
+      goto cleanup;
+    }
+    defs[i].left = row[0];
+    defs[i].top = row[1];
+    defs[i].right = row[2];
+    defs[i].bottom = row[3];
+    defs[i].visible = row[4];
+    defs[i].descriptor = str;
+    defs[i].isRoot = row[5];
+    defs[i].containerIndex = containerIndex;
+    defs[i].widgetClass = row[7];
+  }
+  XPUCreateWidgets(defs, (int)cnt, inParamParent, ioWidgets);
+  created = true;
+
+  if(!(res = PyTuple_New(cnt))){
+    goto cleanup;
+  }
+  for(Py_ssize_t i = 0; i < cnt; ++i){
+    PyTuple_SET_ITEM(res, i, getPtrRef(ioWidgets[i], widgetIDCapsules, widgetRefName));
+  }
+
+  for(Py_ssize_t i = 0; i < numProps; ++i){
+    const int *p = prop + i * WIDGET_TREE_PROP_COLS;
+    if(p[1] < xpProperty_UserStart){
+      XPSetWidgetProperty(ioWidgets[p[0]], p[1], p[2]);
+    }
+  }
+
+  // callbacks go before user properties, so they see xpMsg_PropertyChanged
+  for(Py_ssize_t i = 0; i < numCallbacks; ++i){
+    widgetTreeCallback *c = &treeCallbacks[i];
+    if(!widgetAddCallbackMask(PyTuple_GET_ITEM(res, c->index), ioWidgets[c->index], c->callback, &c->mask)){
+      goto cleanup;
+    }
+  }
+
+  for(Py_ssize_t i = 0; i < numProps; ++i){
+    const int *p = prop + i * WIDGET_TREE_PROP_COLS;
+    if(p[1] >= xpProperty_UserStart){
+      PyObject *value = PyLong_FromLong(p[2]);
+      bool ok = value && widgetSetUserProperty(PyTuple_GET_ITEM(res, p[0]), ioWidgets[p[0]], p[1], value);
+      Py_XDECREF(value);
+      if(!ok){
+        goto cleanup;
+      }
+    }
+  }
+  for(Py_ssize_t i = 0; i < numUserProps; ++i){
+    widgetTreeUserProp *u = &treeUserProps[i];
+    if(u->property < xpProperty_UserStart){
+      XPSetWidgetProperty(ioWidgets[u->index], u->property, u->intValue);
+    }else if(!widgetSetUserProperty(PyTuple_GET_ITEM(res, u->index), ioWidgets[u->index], u->property, u->value)){
+      goto cleanup;
+    }
+  }
+
+ cleanup:
+  if(created && PyErr_Occurred()){
+    // only allocation can fail here: take the tree down again, children with their roots
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    for(Py_ssize_t i = 0; i < cnt; ++i){
+      if(defs[i].containerIndex == NO_PARENT || defs[i].containerIndex == PARAM_PARENT){
+        XPDestroyWidget(ioWidgets[i], 1);
+      }
+    }
+    for(Py_ssize_t i = 0; i < cnt; ++i){
+      removePtrRef(ioWidgets[i], widgetIDCapsules);
+    }
+    PyErr_Restore(type, value, traceback);
+  }
+  for(Py_ssize_t i = 0; treeCallbacks && i < numCallbacks; ++i){
+    Py_XDECREF(treeCallbacks[i].callback);
+  }
+  for(Py_ssize_t i = 0; treeUserProps && i < numUserProps; ++i){
+    Py_XDECREF(treeUserProps[i].value);
+  }
+  free(treeCallbacks);
+  free(treeUserProps);
+  Py_XDECREF(seq);
+  Py_XDECREF(userProps);
+  Py_XDECREF(callbacks);
+  if(text.obj){
+    PyBuffer_Release(&text);
+  }
+  if(propsView.obj){
+    PyBuffer_Release(&propsView);
+  }
+  PyBuffer_Release(&defsView);
+  free(defs);
+  free(ioWidgets);
+  if(PyErr_Occurred()){
+    Py_XDECREF(res);
+    return NULL;
+  }
+  return res;
+}
+
 static PyObject *XPUMoveWidgetByFun(PyObject *self, PyObject *args)
 {
   (void) self;
@@ -236,6 +516,7 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
 
 static PyMethodDef XPWidgetUtilsMethods[] = {
   {"XPUCreateWidgets", XPUCreateWidgetsFun, METH_VARARGS, ""},
+  {"XPUCreateWidgetTree", XPUCreateWidgetTreeFun, METH_VARARGS, ""},
   {"XPUMoveWidgetBy", XPUMoveWidgetByFun, METH_VARARGS, ""},
   {"XPUFixedLayout", XPUFixedLayoutFun, METH_VARARGS, ""},
   {"XPUSelectIfNeeded", XPUSelectIfNeededFun, METH_VARARGS, ""},
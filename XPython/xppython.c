@@ -6,10 +6,74 @@
 #include <structmember.h>
 #include "xppythontypes.h"
 #include "utils.h"
+#include "trace.h"
 
 PyObject *xppythonDicts = NULL, *xppythonCapsules = NULL;
 extern const char *pythonPluginVersion, *pythonPluginsPath, *pythonInternalPluginsPath;
 
+/* Result objects may be returned many times per frame, so Py*_New() fill in fields directly,
+   rather than calling the type, and instances of the exact type are recycled through small
+   free lists rather than being freed. */
+#define FREELIST_MAX 64
+
+typedef struct {
+  PyObject *items[FREELIST_MAX];
+  int count;
+} freeList;
+
+static PyObject *freeListAlloc(freeList *list, PyTypeObject *type)
+{
+  if(list->count){
+    PyObject *self = list->items[--list->count];
+    PyObject_Init(self, type);
+    if(PyType_IS_GC(type)){
+      PyObject_GC_Track(self);
+    }
+    return self;
+  }
+  return type->tp_alloc(type, 0);
+}
+
+// Returns true if the object was kept; references it holds must already be cleared
+static bool freeListPush(freeList *list, PyObject *self, PyTypeObject *type)
+{
+  if(Py_TYPE(self) == type && list->count < FREELIST_MAX){
+    list->items[list->count++] = self;
+    return true;
+  }
+  return false;
+}
+
+static void freeListClear(freeList *list, PyTypeObject *type)
+{
+  while(list->count){
+    type->tp_free(list->items[--list->count]);
+  }
+}
+
+// Buffer of a reference-free object's fields, as a single read-only struct described by format
+static int getStructBuffer(PyObject *self, Py_buffer *view, int flags, void *buf, Py_ssize_t len, const char *format)
+{
+  if(flags & PyBUF_WRITABLE){
+    PyErr_SetString(PyExc_BufferError, "Object is not writable.");
+    view->obj = NULL;
+    return -1;
+  }
+  Py_INCREF(self);
+  view->obj = self;
+  view->buf = buf;
+  view->len = len;
+  view->readonly = 1;
+  view->itemsize = len;
+  view->format = (flags & PyBUF_FORMAT) ? (char *)format : NULL;
+  view->ndim = 0;
+  view->shape = NULL;
+  view->strides = NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
 /* HotKeyInfo Type */
 typedef struct {
   PyObject_HEAD
@@ -19,6 +83,9 @@ typedef struct {
   int plugin;
 } HotKeyInfoObject;
 
+static PyTypeObject HotKeyInfoType;
+static freeList hotKeyInfoFreeList;
+
 static PyObject *
 HotKeyInfo_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -58,6 +125,9 @@ HotKeyInfo_dealloc(HotKeyInfoObject *self)
 {
   PyObject_GC_UnTrack(self);
   HotKeyInfo_clear(self);
+  if(freeListPush(&hotKeyInfoFreeList, (PyObject *) self, &HotKeyInfoType)){
+    return;
+  }
   Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
@@ -106,10 +176,19 @@ static PyTypeObject HotKeyInfoType = {
 PyObject *
 PyHotKeyInfo_New(int virtualKey, int flags, char *description, int plugin)
 {
-  PyObject *argsList = Py_BuildValue("iisi", virtualKey, flags, description, plugin);
-  PyObject *obj = PyObject_CallObject((PyObject *) &HotKeyInfoType, argsList);
-  Py_DECREF(argsList);
-  return (PyObject*)obj;
+  HotKeyInfoObject *self = (HotKeyInfoObject *) freeListAlloc(&hotKeyInfoFreeList, &HotKeyInfoType);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->virtualKey = virtualKey;
+  self->flags = flags;
+  self->plugin = plugin;
+  self->description = PyUnicode_FromString(description);
+  if (self->description == NULL) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  return (PyObject *) self;
 }
 
 /* ProbeInfo Type */
@@ -128,6 +207,9 @@ typedef struct {
   int is_wet;
 } ProbeInfoObject;
 
+static PyTypeObject ProbeInfoType;
+static freeList probeInfoFreeList;
+
 static PyObject *
 ProbeInfo_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -138,30 +220,27 @@ ProbeInfo_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
   return (PyObject *) self;
 }
 
-static int
-ProbeInfo_traverse(ProbeInfoObject *self, visitproc visit, void *arg)
+static void
+ProbeInfo_dealloc(ProbeInfoObject *self)
 {
-  (void) self;
-  (void) visit;
-  (void) arg;
-  return 0;
+  if(freeListPush(&probeInfoFreeList, (PyObject *) self, &ProbeInfoType)){
+    return;
+  }
+  Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
 static int
-ProbeInfo_clear(ProbeInfoObject *self)
+ProbeInfo_getbuffer(ProbeInfoObject *self, Py_buffer *view, int flags)
 {
-  (void) self;
-  return 0;
-}
-    
-static void
-ProbeInfo_dealloc(ProbeInfoObject *self)
-{
-  PyObject_GC_UnTrack(self);
-  ProbeInfo_clear(self);
-  Py_TYPE(self)->tp_free((PyObject *) self);
+  // result, location, normal, velocity, is_wet
+  return getStructBuffer((PyObject *) self, view, flags, &self->result,
+                         offsetof(ProbeInfoObject, is_wet) + sizeof(int) - offsetof(ProbeInfoObject, result), "i9fi");
 }
 
+static PyBufferProcs ProbeInfo_as_buffer = {
+  .bf_getbuffer = (getbufferproc) ProbeInfo_getbuffer,
+};
+
 static int
 ProbeInfo_init(ProbeInfoObject *self, PyObject *args, PyObject *kwds)
 {
@@ -201,13 +280,12 @@ static PyTypeObject ProbeInfoType = {
                                       .tp_doc = "ProbeInfo",
                                       .tp_basicsize = sizeof(ProbeInfoObject),
                                       .tp_itemsize = 0,
-                                      .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+                                      .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
                                       .tp_new = ProbeInfo_new,
                                       .tp_init = (initproc) ProbeInfo_init,
                                       .tp_dealloc = (destructor) ProbeInfo_dealloc,
-                                      .tp_traverse = (traverseproc) ProbeInfo_traverse,
-                                      .tp_clear = (inquiry) ProbeInfo_clear,
                                       .tp_members = ProbeInfo_members,
+                                      .tp_as_buffer = &ProbeInfo_as_buffer,
 
 };
 
@@ -215,11 +293,21 @@ static PyTypeObject ProbeInfoType = {
 PyObject *
 PyProbeInfo_New(int result, float locationX, float locationY, float locationZ, float normalX, float normalY, float normalZ, float velocityX, float velocityY, float velocityZ, int is_wet)
 {
-  PyObject *argsList = Py_BuildValue("ifffffffffi", result, locationX, locationY, locationZ, normalX, normalY, normalZ,
-                                     velocityX, velocityY, velocityZ, is_wet);
-  PyObject *obj = PyObject_CallObject((PyObject *) &ProbeInfoType, argsList);
-  Py_DECREF(argsList);
-  return (PyObject*)obj;
+  ProbeInfoObject *self = (ProbeInfoObject *) freeListAlloc(&probeInfoFreeList, &ProbeInfoType);
+  if (self != NULL) {
+    self->result = result;
+    self->locationX = locationX;
+    self->locationY = locationY;
+    self->locationZ = locationZ;
+    self->normalX = normalX;
+    self->normalY = normalY;
+    self->normalZ = normalZ;
+    self->velocityX = velocityX;
+    self->velocityY = velocityY;
+    self->velocityZ = velocityZ;
+    self->is_wet = is_wet;
+  }
+  return (PyObject *) self;
 }
 
 /* Plugininfo Type */
@@ -374,6 +462,9 @@ typedef struct {
   int reg;
 } NavAidInfoObject;
 
+static PyTypeObject NavAidInfoType;
+static freeList navAidInfoFreeList;
+
 static PyObject *
 NavAidInfo_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -424,6 +515,9 @@ NavAidInfo_dealloc(NavAidInfoObject *self)
 {
   PyObject_GC_UnTrack(self);
   NavAidInfo_clear(self);
+  if(freeListPush(&navAidInfoFreeList, (PyObject *) self, &NavAidInfoType)){
+    return;
+  }
   Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
@@ -431,7 +525,7 @@ static int
 NavAidInfo_init(NavAidInfoObject *self, PyObject *args, PyObject *kwds)
 {
   static char *kwlist[] = {"type", "latitude", "longitude", "height", "frequency", "heading", "navaAidID", "name", "reg", NULL};
-  PyObject *navAidID = NULL, *name, *tmp;
+  PyObject *navAidID = NULL, *name = NULL, *tmp;
   if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ifffifUUi", kwlist,
                                    &self->type, &self->latitude, &self->longitude, &self->height, &self->frequency, &self->heading,
                                    &navAidID, &name, &self->reg))
@@ -484,10 +578,24 @@ static PyTypeObject NavAidInfoType = {
 PyObject *
 PyNavAidInfo_New(int type, float latitude, float longitude, float height, int frequency, float heading, char* navAidID, char *name, int reg)
 {
-  PyObject *argsList = Py_BuildValue("ifffifUUi", type, latitude, longitude, height, frequency, heading, navAidID, name, reg);
-  PyObject *obj = PyObject_CallObject((PyObject *) &NavAidInfoType, argsList);
-  Py_DECREF(argsList);
-  return (PyObject*)obj;
+  NavAidInfoObject *self = (NavAidInfoObject *) freeListAlloc(&navAidInfoFreeList, &NavAidInfoType);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->type = type;
+  self->latitude = latitude;
+  self->longitude = longitude;
+  self->height = height;
+  self->frequency = frequency;
+  self->heading = heading;
+  self->reg = reg;
+  self->navAidID = PyUnicode_FromString(navAidID);
+  self->name = self->navAidID ? PyUnicode_FromString(name) : NULL;
+  if (self->name == NULL) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  return (PyObject *) self;
 }
 
 /* FMSEntryInfo TYPE */
@@ -501,6 +609,9 @@ typedef struct {
   float lon;
 } FMSEntryInfoObject;
 
+static PyTypeObject FMSEntryInfoType;
+static freeList fmsEntryInfoFreeList;
+
 static PyObject *
 FMSEntryInfo_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -542,6 +653,9 @@ FMSEntryInfo_dealloc(FMSEntryInfoObject *self)
 {
   PyObject_GC_UnTrack(self);
   FMSEntryInfo_clear(self);
+  if(freeListPush(&fmsEntryInfoFreeList, (PyObject *) self, &FMSEntryInfoType)){
+    return;
+  }
   Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
@@ -592,10 +706,21 @@ static PyTypeObject FMSEntryInfoType = {
 PyObject *
 PyFMSEntryInfo_New(int type, char *navAidID, int ref, int altitude, float lat, float lon)
 {
-  PyObject *argsList = Py_BuildValue("iUiiff", type, navAidID, ref, altitude, lat, lon);
-  PyObject *obj = PyObject_CallObject((PyObject *) &FMSEntryInfoType, argsList);
-  Py_DECREF(argsList);
-  return (PyObject*)obj;
+  FMSEntryInfoObject *self = (FMSEntryInfoObject *) freeListAlloc(&fmsEntryInfoFreeList, &FMSEntryInfoType);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->type = type;
+  self->ref = ref;
+  self->altitude = altitude;
+  self->lat = lat;
+  self->lon = lon;
+  self->navAidID = PyUnicode_FromString(navAidID);
+  if (self->navAidID == NULL) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  return (PyObject *) self;
 }
 
 /* TrackMetrics TYPE */
@@ -609,6 +734,9 @@ typedef struct {
   int upBtnSize;
 } TrackMetricsObject;
 
+static PyTypeObject TrackMetricsType;
+static freeList trackMetricsFreeList;
+
 static PyObject *
 TrackMetrics_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -627,27 +755,25 @@ TrackMetrics_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
   return (PyObject *) self;
 }
 
-static int
-TrackMetrics_traverse(TrackMetricsObject *self, visitproc visit, void *arg)
+static void
+TrackMetrics_dealloc(TrackMetricsObject *self)
 {
-  (void) self;
-  (void) visit;
-  (void) arg;
-  return 0;
+  if(freeListPush(&trackMetricsFreeList, (PyObject *) self, &TrackMetricsType)){
+    return;
+  }
+  Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
 static int
-TrackMetrics_clear(TrackMetricsObject *self)
+TrackMetrics_getbuffer(TrackMetricsObject *self, Py_buffer *view, int flags)
 {
-  (void)self;
-  return 0;
+  return getStructBuffer((PyObject *) self, view, flags, &self->isVertical,
+                         offsetof(TrackMetricsObject, upBtnSize) + sizeof(int) - offsetof(TrackMetricsObject, isVertical), "6i");
 }
 
-static void
-TrackMetrics_dealloc(TrackMetricsObject *self)
-{
-  Py_TYPE(self)->tp_free((PyObject *) self);
-}
+static PyBufferProcs TrackMetrics_as_buffer = {
+  .bf_getbuffer = (getbufferproc) TrackMetrics_getbuffer,
+};
 
 static int
 TrackMetrics_init(TrackMetricsObject *self, PyObject *args, PyObject *kwds)
@@ -676,23 +802,28 @@ static PyTypeObject TrackMetricsType = {
                                       .tp_doc = "TrackMetrics",
                                       .tp_basicsize = sizeof(TrackMetricsObject),
                                       .tp_itemsize = 0,
-                                      .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+                                      .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
                                       .tp_new = TrackMetrics_new,
                                       .tp_init = (initproc) TrackMetrics_init,
                                       .tp_dealloc = (destructor) TrackMetrics_dealloc,
-                                      .tp_traverse = (traverseproc) TrackMetrics_traverse,
-                                      .tp_clear = (inquiry) TrackMetrics_clear,
                                       .tp_members = TrackMetrics_members,
+                                      .tp_as_buffer = &TrackMetrics_as_buffer,
 };
 
 
 PyObject *
 PyTrackMetrics_New(int isVertical, int downBtnSize, int downPageSize, int thumbSize, int upPageSize, int upBtnSize)
 {
-  PyObject *argsList = Py_BuildValue("iiiiii", isVertical, downBtnSize, downPageSize, thumbSize, upPageSize, upBtnSize);
-  PyObject *obj = PyObject_CallObject((PyObject *) &TrackMetricsType, argsList);
-  Py_DECREF(argsList);
-  return (PyObject*)obj;
+  TrackMetricsObject *self = (TrackMetricsObject *) freeListAlloc(&trackMetricsFreeList, &TrackMetricsType);
+  if (self != NULL) {
+    self->isVertical = isVertical;
+    self->downBtnSize = downBtnSize;
+    self->downPageSize = downPageSize;
+    self->thumbSize = thumbSize;
+    self->upPageSize = upPageSize;
+    self->upBtnSize = upBtnSize;
+  }
+  return (PyObject *) self;
 }
 
 
@@ -711,10 +842,53 @@ static PyObject *XPPythonGetCapsulesFun(PyObject *self, PyObject *args)
   return xppythonCapsules;
 }
 
+static PyObject *XPPythonTraceStartFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  Py_ssize_t capacity = 1 << 16;
+  if(!PyArg_ParseTuple(args, "|n", &capacity)){
+    return NULL;
+  }
+  if(!traceStart(capacity)){
+    PyErr_SetString(PyExc_RuntimeError, "XPPythonTraceStart couldn't allocate the trace buffer.");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPPythonTraceStopFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  (void) args;
+  traceStop();
+  Py_RETURN_NONE;
+}
+
+static PyObject *XPPythonTraceDumpFun(PyObject *self, PyObject *args)
+{
+  (void) self;
+  const char *fname;
+  if(!PyArg_ParseTuple(args, "s", &fname)){
+    return NULL;
+  }
+  long res = traceDump(fname);
+  if(res < 0){
+    PyErr_SetString(PyExc_RuntimeError, "XPPythonTraceDump couldn't open the output file.");
+    return NULL;
+  }
+  return PyLong_FromLong(res);
+}
+
 static PyObject *cleanup(PyObject *self, PyObject *args)
 {
   (void) self;
   (void) args;
+  traceCleanup();
+  freeListClear(&hotKeyInfoFreeList, &HotKeyInfoType);
+  freeListClear(&probeInfoFreeList, &ProbeInfoType);
+  freeListClear(&navAidInfoFreeList, &NavAidInfoType);
+  freeListClear(&fmsEntryInfoFreeList, &FMSEntryInfoType);
+  freeListClear(&trackMetricsFreeList, &TrackMetricsType);
   PyDict_Clear(xppythonDicts);
   Py_DECREF(xppythonDicts);
   PyDict_Clear(xppythonCapsules);
@@ -725,6 +899,9 @@ static PyObject *cleanup(PyObject *self, PyObject *args)
 static PyMethodDef XPPythonMethods[] = {
   {"XPPythonGetDicts", XPPythonGetDictsFun, METH_VARARGS, ""},
   {"XPPythonGetCapsules", XPPythonGetCapsulesFun, METH_VARARGS, ""},
+  {"XPPythonTraceStart", XPPythonTraceStartFun, METH_VARARGS, ""},
+  {"XPPythonTraceStop", XPPythonTraceStopFun, METH_VARARGS, ""},
+  {"XPPythonTraceDump", XPPythonTraceDumpFun, METH_VARARGS, ""},
   {"cleanup", cleanup, METH_VARARGS, ""},
   {NULL, NULL, 0, NULL}
 };